@@ -2,47 +2,49 @@
 #define ANGLE
 
 #include <vector>
+#include <numeric>
 
 #include "greedy.hpp"
 
 /**
  * @brief The Angle class
- * Specialized version of the greedy algorithm, where the segments are sorted by angle
+ * Specialized version of the greedy algorithm, where the segments are sorted by angle.
+ * The segments are sorted once, comparing their slopes exactly
  */
 class Angle : public Greedy
 {
 protected:
-    class Compare {
-        std::vector<Segment> *p;
-    public:
-        Compare(std::vector<Segment> *_p) : p(_p) {}
-        bool operator()(int x, int y) const {
-            return std::make_tuple(p->at(x).slope(), x) < std::make_tuple(p->at(y).slope(), y);
-        }
-    };
-
-    Compare cmp;
+    std::vector<int> order; // (indices of) the segments sorted by slope, and by index for the same slope
+    std::vector<int> rank; // rank[i] = position of the i-th segment in order
 
 public:
-    Angle(Parameters param) : Greedy(param), cmp(&segments)
-    {}
+    Angle(Parameters param) : Greedy(param), order(segments.size()), rank(segments.size())
+    {
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [this](int x, int y) {
+            const int c = segments[x].compare_slope(segments[y]);
+            return c < 0 || (c == 0 && x < y);
+        });
+        for (unsigned int k = 0; k < order.size(); k++)
+            rank[order[k]] = k;
+    }
 
     virtual void clearSol() {
         Greedy::clearSol();
     }
 
+    virtual Solution *clone() const
+    {
+        return new Angle(*this);
+    }
+
     virtual void color() {
         clearSol();
 
-        std::vector<int> indices;
-        for (unsigned int si = 0; si < segments.size(); si++)
-            indices.push_back(si);
-
-        std::sort(indices.begin(), indices.end(), cmp); // sort the segments by angle
-        int r = rand() % indices.size(); // start at a random position
+        int r = rng() % order.size(); // start at a random position
         std::vector<int> uncolored;
         for (unsigned int si = 0; si < segments.size(); si++)
-            uncolored.push_back(indices[(si + r) % segments.size()]);
+            uncolored.push_back(order[(si + r) % segments.size()]);
 
         greedy(uncolored);
     }
@@ -2,43 +2,76 @@
 #define BAD
 
 #include "angle.hpp"
-#include <set>
 #include <cstdlib>
 
+/**
+ * @brief The Bad class
+ * Specialized version of the angle algorithm. The segments of the last color of a
+ * repetition are bad, and the next repetitions color the good segments first, then
+ * the bad ones, each in the order of their slopes. A repetition keeps the colors of
+ * the segments colored before the first change of this order
+ */
 class Bad : public Angle {
-    std::set<int, Compare> good, bad;
+    std::vector<int> good, bad; // segments sorted by slope, as in order
+    std::vector<char> is_bad; // is_bad[i] = true if the i-th segment is in bad
 
 public:
-    Bad(Parameters param) : Angle(param), good(cmp), bad(cmp) {
+    Bad(Parameters param) : Angle(param), is_bad(segments.size(), false) {
+    }
+
+    /**
+     * @brief clone
+     * Each repetition starts from the segments of the last color of the previous
+     * one, so that the repetitions cannot run in parallel
+     */
+    virtual Solution *clone() const
+    {
+        return nullptr;
     }
 
     void clearGoodBad() {
         Angle::clearSol();
         good.clear();
         bad.clear();
+        std::fill(is_bad.begin(), is_bad.end(), false);
     }
 
     virtual void color() {
-        clearSol();
+        if (colored.empty())
+            clearSol();
 
         if (good.empty() && bad.empty())
-            for (unsigned int si=0; si<segments.size(); si++)
-                good.insert(si);
+            good = order;
 
         std::clog << "Bad=" << bad.size() << " Good=" << good.size() << " ";
 
-        std::vector<int> uncolored;
-        for (int vi : good)
-            uncolored.push_back(vi);
-        for (int vi : bad)
-            uncolored.push_back(vi);
+        std::vector<int> uncolored(good);
+        uncolored.insert(uncolored.end(), bad.begin(), bad.end());
 
+        // The greedy algorithm colors the segments from the end of uncolored. Until the
+        // first segment that changed since the previous repetition, it colors them as in
+        // the previous repetition, so that we only restart it from there
+        size_t same = 0;
+        while (same < colored.size() && same < uncolored.size() && colored[same] == uncolored[uncolored.size() - 1 - same])
+            same++;
+        rewind(same);
+        uncolored.resize(uncolored.size() - same);
         greedy(uncolored);
 
-        for (int vi : classes.back()) {
-            bad.insert(vi);
-            good.erase(vi);
-        }
+        // Move the segments of the last color from good to bad, keeping both sorted
+        std::vector<int> moved;
+        for (int vi : classes.back())
+            if (!is_bad[vi])
+            {
+                is_bad[vi] = true;
+                moved.push_back(vi);
+            }
+        auto by_rank = [this](int x, int y) { return rank[x] < rank[y]; };
+        std::sort(moved.begin(), moved.end(), by_rank);
+        good.erase(std::remove_if(good.begin(), good.end(), [this](int vi) { return is_bad[vi]; }), good.end());
+        std::vector<int> merged(bad.size() + moved.size());
+        std::merge(bad.begin(), bad.end(), moved.begin(), moved.end(), merged.begin(), by_rank);
+        bad.swap(merged);
     }
 
     virtual ~Bad() = default;
@@ -0,0 +1,245 @@
+#ifndef BATCH
+#define BATCH
+
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <immintrin.h>
+
+#include "primitives.hpp"
+
+/**
+ * @brief The SegmentBatch class
+ * Structure-of-arrays copy of the endpoints of the segments, used to test one segment
+ * against a block of up to 16 segments at once.
+ * The orientation tests of a block are computed with AVX-512 or AVX2 when the
+ * processor supports it. Segments whose bounding boxes are disjoint are rejected,
+ * and the rare pairs with three collinear endpoints fall back to Segment::cross
+ */
+class SegmentBatch
+{
+public:
+    static constexpr int block = 16; // maximum number of segments tested at once
+
+private:
+    std::vector<i64> px, py, qx, qy; // endpoints of the segments, with p < q
+    std::vector<i64> ylo, yhi; // vertical extent of the segments
+    unsigned (SegmentBatch::*kernel)(int, const int *, int) const = &SegmentBatch::cross_scalar;
+
+    Segment segment(int si) const
+    {
+        return Segment(Point(px[si], py[si]), Point(qx[si], qy[si]));
+    }
+
+    unsigned cross_scalar(int si, const int *idx, int n) const
+    {
+        const Segment s = segment(si);
+        unsigned mask = 0;
+        for (int k = 0; k < n; k++)
+        {
+            const int sj = idx[k];
+            if (qx[sj] < px[si] || qx[si] < px[sj] || yhi[sj] < ylo[si] || yhi[si] < ylo[sj])
+                continue;
+            if (s.cross(segment(sj)))
+                mask |= 1u << k;
+        }
+        return mask;
+    }
+
+    /**
+     * @brief fallback
+     * Test with Segment::cross the segments of a block where some orientation is zero
+     */
+    unsigned fallback(int si, const int *idx, unsigned lanes) const
+    {
+        const Segment s = segment(si);
+        unsigned mask = 0;
+        for (; lanes; lanes &= lanes - 1)
+        {
+            const int k = __builtin_ctz(lanes);
+            if (s.cross(segment(idx[k])))
+                mask |= 1u << k;
+        }
+        return mask;
+    }
+
+    /*
+     * The vectorized kernels require the differences of coordinates to fit in 32 bits,
+     * as the products are computed with a signed 32x32->64 bits multiplication.
+     * Orientation of r with respect to (p,q): (q.y-p.y)*(r.x-q.x) - (q.x-p.x)*(r.y-q.y)
+     */
+
+    __attribute__((target("avx2")))
+    static __m256i orientation(__m256i d1, __m256i d2, __m256i d3, __m256i d4)
+    {
+        return _mm256_sub_epi64(_mm256_mul_epi32(d1, d2), _mm256_mul_epi32(d3, d4));
+    }
+
+    __attribute__((target("avx2")))
+    unsigned cross_avx2(int si, const int *idx, int n) const
+    {
+        const __m256i pxi = _mm256_set1_epi64x(px[si]), pyi = _mm256_set1_epi64x(py[si]);
+        const __m256i qxi = _mm256_set1_epi64x(qx[si]), qyi = _mm256_set1_epi64x(qy[si]);
+        const __m256i loi = _mm256_set1_epi64x(ylo[si]), hii = _mm256_set1_epi64x(yhi[si]);
+        const __m256i dxi = _mm256_sub_epi64(qxi, pxi), dyi = _mm256_sub_epi64(qyi, pyi);
+        const __m256i zero = _mm256_setzero_si256();
+
+        unsigned result = 0, slow = 0;
+        for (int k = 0; k < n; k += 4)
+        {
+            int lane_idx[4];
+            for (int l = 0; l < 4; l++)
+                lane_idx[l] = idx[std::min(k + l, n - 1)];
+            const __m128i vi = _mm_loadu_si128((const __m128i *) lane_idx);
+            const __m256i pxj = _mm256_i32gather_epi64((const long long *) px.data(), vi, 8);
+            const __m256i pyj = _mm256_i32gather_epi64((const long long *) py.data(), vi, 8);
+            const __m256i qxj = _mm256_i32gather_epi64((const long long *) qx.data(), vi, 8);
+            const __m256i qyj = _mm256_i32gather_epi64((const long long *) qy.data(), vi, 8);
+            const __m256i loj = _mm256_i32gather_epi64((const long long *) ylo.data(), vi, 8);
+            const __m256i hij = _mm256_i32gather_epi64((const long long *) yhi.data(), vi, 8);
+
+            const __m256i disjoint = _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpgt_epi64(pxi, qxj), _mm256_cmpgt_epi64(pxj, qxi)),
+                        _mm256_or_si256(_mm256_cmpgt_epi64(loi, hij), _mm256_cmpgt_epi64(loj, hii)));
+
+            const __m256i dxj = _mm256_sub_epi64(qxj, pxj), dyj = _mm256_sub_epi64(qyj, pyj);
+            const __m256i o1 = orientation(dyi, _mm256_sub_epi64(pxj, qxi), dxi, _mm256_sub_epi64(pyj, qyi));
+            const __m256i o2 = orientation(dyi, _mm256_sub_epi64(qxj, qxi), dxi, _mm256_sub_epi64(qyj, qyi));
+            const __m256i o3 = orientation(dyj, _mm256_sub_epi64(pxi, qxj), dxj, _mm256_sub_epi64(pyi, qyj));
+            const __m256i o4 = orientation(dyj, _mm256_sub_epi64(qxi, qxj), dxj, _mm256_sub_epi64(qyi, qyj));
+
+            const __m256i colinear = _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi64(o1, zero), _mm256_cmpeq_epi64(o2, zero)),
+                        _mm256_or_si256(_mm256_cmpeq_epi64(o3, zero), _mm256_cmpeq_epi64(o4, zero)));
+            const __m256i proper = _mm256_and_si256(_mm256_xor_si256(o1, o2), _mm256_xor_si256(o3, o4)); // sign bits differ
+
+            const unsigned valid = ((1u << std::min(n - k, 4)) - 1) & ~_mm256_movemask_pd(_mm256_castsi256_pd(disjoint));
+            const unsigned col = _mm256_movemask_pd(_mm256_castsi256_pd(colinear));
+            result |= (valid & ~col & _mm256_movemask_pd(_mm256_castsi256_pd(proper))) << k;
+            slow |= (valid & col) << k;
+        }
+        return slow ? result | fallback(si, idx, slow) : result;
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i orientation(__m512i d1, __m512i d2, __m512i d3, __m512i d4)
+    {
+        return _mm512_sub_epi64(_mm512_maskz_mul_epi32(0xff, d1, d2), _mm512_maskz_mul_epi32(0xff, d3, d4));
+    }
+
+    __attribute__((target("avx512f")))
+    unsigned cross_avx512(int si, const int *idx, int n) const
+    {
+        const __m512i pxi = _mm512_set1_epi64(px[si]), pyi = _mm512_set1_epi64(py[si]);
+        const __m512i qxi = _mm512_set1_epi64(qx[si]), qyi = _mm512_set1_epi64(qy[si]);
+        const __m512i loi = _mm512_set1_epi64(ylo[si]), hii = _mm512_set1_epi64(yhi[si]);
+        const __m512i dxi = _mm512_sub_epi64(qxi, pxi), dyi = _mm512_sub_epi64(qyi, pyi);
+        const __m512i zero = _mm512_setzero_si512();
+
+        unsigned result = 0, slow = 0;
+        for (int k = 0; k < n; k += 8)
+        {
+            int lane_idx[8];
+            for (int l = 0; l < 8; l++)
+                lane_idx[l] = idx[std::min(k + l, n - 1)];
+            const __mmask8 lanes = (1u << std::min(n - k, 8)) - 1;
+            const __m256i vi = _mm256_loadu_si256((const __m256i *) lane_idx);
+            const __m512i pxj = _mm512_mask_i32gather_epi64(zero, lanes, vi, px.data(), 8);
+            const __m512i pyj = _mm512_mask_i32gather_epi64(zero, lanes, vi, py.data(), 8);
+            const __m512i qxj = _mm512_mask_i32gather_epi64(zero, lanes, vi, qx.data(), 8);
+            const __m512i qyj = _mm512_mask_i32gather_epi64(zero, lanes, vi, qy.data(), 8);
+            const __m512i loj = _mm512_mask_i32gather_epi64(zero, lanes, vi, ylo.data(), 8);
+            const __m512i hij = _mm512_mask_i32gather_epi64(zero, lanes, vi, yhi.data(), 8);
+
+            const __mmask8 valid = lanes
+                    & _mm512_cmple_epi64_mask(pxi, qxj) & _mm512_cmple_epi64_mask(pxj, qxi)
+                    & _mm512_cmple_epi64_mask(loi, hij) & _mm512_cmple_epi64_mask(loj, hii);
+
+            const __m512i dxj = _mm512_sub_epi64(qxj, pxj), dyj = _mm512_sub_epi64(qyj, pyj);
+            const __m512i o1 = orientation(dyi, _mm512_sub_epi64(pxj, qxi), dxi, _mm512_sub_epi64(pyj, qyi));
+            const __m512i o2 = orientation(dyi, _mm512_sub_epi64(qxj, qxi), dxi, _mm512_sub_epi64(qyj, qyi));
+            const __m512i o3 = orientation(dyj, _mm512_sub_epi64(pxi, qxj), dxj, _mm512_sub_epi64(pyi, qyj));
+            const __m512i o4 = orientation(dyj, _mm512_sub_epi64(qxi, qxj), dxj, _mm512_sub_epi64(qyi, qyj));
+
+            const __mmask8 col = _mm512_cmpeq_epi64_mask(o1, zero) | _mm512_cmpeq_epi64_mask(o2, zero)
+                    | _mm512_cmpeq_epi64_mask(o3, zero) | _mm512_cmpeq_epi64_mask(o4, zero);
+            const __mmask8 proper = _mm512_cmplt_epi64_mask(_mm512_and_epi64(_mm512_xor_epi64(o1, o2), _mm512_xor_epi64(o3, o4)), zero);
+
+            result |= (unsigned) (valid & ~col & proper) << k;
+            slow |= (unsigned) (valid & col) << k;
+        }
+        return slow ? result | fallback(si, idx, slow) : result;
+    }
+
+public:
+    SegmentBatch()
+    {}
+
+    SegmentBatch(const std::vector<Segment> &segments)
+    {
+        const i64 limit = 1 << 30;
+        bool narrow = true; // true if all the coordinates are in [-2^30, 2^30)
+        for (const Segment &s : segments)
+        {
+            px.push_back(s.get_p().x);
+            py.push_back(s.get_p().y);
+            qx.push_back(s.get_q().x);
+            qy.push_back(s.get_q().y);
+            ylo.push_back(std::min(s.get_p().y, s.get_q().y));
+            yhi.push_back(std::max(s.get_p().y, s.get_q().y));
+            for (i64 v : {px.back(), py.back(), qx.back(), qy.back()})
+                narrow = narrow && v >= -limit && v < limit;
+        }
+
+        __builtin_cpu_init();
+        if (narrow && __builtin_cpu_supports("avx512f"))
+            kernel = &SegmentBatch::cross_avx512;
+        else if (narrow && __builtin_cpu_supports("avx2"))
+            kernel = &SegmentBatch::cross_avx2;
+    }
+
+    /**
+     * @brief cross
+     * Test one segment against a block of segments
+     * @param si Index of a segment
+     * @param idx Indices of the segments of the block
+     * @param n Size of the block, at most `block`
+     * @return Mask whose k-th bit is set if the si-th segment crosses the idx[k]-th segment
+     */
+    unsigned cross(int si, const int *idx, int n) const
+    {
+        return (this->*kernel)(si, idx, n);
+    }
+
+    /**
+     * @brief cross_any
+     * @param si Index of a segment
+     * @param idx Indices of segments
+     * @param n Number of segments
+     * @return True if the si-th segment crosses one of the n segments
+     */
+    bool cross_any(int si, const int *idx, int n) const
+    {
+        for (int k = 0; k < n; k += block)
+            if (cross(si, idx + k, std::min(block, n - k)))
+                return true;
+        return false;
+    }
+
+    /**
+     * @brief cross_count
+     * @param si Index of a segment
+     * @param idx Indices of segments
+     * @param n Number of segments
+     * @return Number of the n segments crossing the si-th segment
+     */
+    int cross_count(int si, const int *idx, int n) const
+    {
+        int count = 0;
+        for (int k = 0; k < n; k += block)
+            count += __builtin_popcount(cross(si, idx + k, std::min(block, n - k)));
+        return count;
+    }
+};
+
+#endif // BATCH
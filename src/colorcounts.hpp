@@ -0,0 +1,182 @@
+#ifndef COLORCOUNTS
+#define COLORCOUNTS
+
+#include <vector>
+#include <algorithm>
+
+#include "crossings.hpp"
+
+/**
+ * @brief The ColorCounts class
+ * Table giving, for each segment and each color, the number of segments of the
+ * color crossing the segment, and the sum of their weights.
+ * Segments can also be blocked: they are counted, but instead of adding their
+ * weight, they mark the colors containing them as unavailable to the segments
+ * they cross.
+ * The table is updated in O(degree) when a segment changes color or weight, so
+ * that the colors available to a segment are found by scanning its row.
+ * The weights and the blocks are optional: without them, a cell takes 4 bytes
+ * instead of 16, and only the counts are kept
+ */
+class ColorCounts
+{
+    int m = 0; // number of segments
+    int stride = 0; // number of colors allocated per row
+    bool weighted = true; // true if the weights and the blocks are kept
+    std::vector<int> counts; // counts[si*stride+c] = number of segments of color c crossing si
+    std::vector<int> blocks; // blocks[si*stride+c] = number of blocked segments of color c crossing si
+    std::vector<double> weights; // weights[si*stride+c] = sum of the weights of the other segments of color c crossing si
+
+    /**
+     * @brief grow
+     * Reallocate the rows for at least nb_colors colors
+     */
+    void grow(int nb_colors)
+    {
+        const int new_stride = std::max(nb_colors, 2 * stride);
+        const size_t cells = weighted ? (size_t) m * new_stride : 0;
+        std::vector<int> new_counts((size_t) m * new_stride, 0), new_blocks(cells, 0);
+        std::vector<double> new_weights(cells, 0);
+        for (size_t si = 0; si < (size_t) m; si++)
+            for (int c = 0; c < stride; c++)
+            {
+                new_counts[si * new_stride + c] = counts[si * stride + c];
+                if (weighted)
+                {
+                    new_blocks[si * new_stride + c] = blocks[si * stride + c];
+                    new_weights[si * new_stride + c] = weights[si * stride + c];
+                }
+            }
+        counts.swap(new_counts);
+        blocks.swap(new_blocks);
+        weights.swap(new_weights);
+        stride = new_stride;
+    }
+
+public:
+    /**
+     * @brief assign
+     * Empty the table
+     * @param nb_segments
+     * @param nb_colors Number of colors to allocate. More colors are allocated when needed
+     * @param with_weights False to keep only the counts, the weights and the blocks being ignored
+     */
+    void assign(int nb_segments, int nb_colors, bool with_weights = true)
+    {
+        m = nb_segments;
+        stride = std::max(nb_colors, 1);
+        weighted = with_weights;
+        const size_t cells = weighted ? (size_t) m * stride : 0;
+        counts.assign((size_t) m * stride, 0);
+        blocks.assign(cells, 0);
+        weights.assign(cells, 0);
+        blocks.shrink_to_fit();
+        weights.shrink_to_fit();
+    }
+
+    /**
+     * @brief add
+     * Add (or remove, with sign = -1) the segment si to the color c
+     * @param crossings
+     * @param si
+     * @param c
+     * @param sign 1 to add the segment, -1 to remove it
+     * @param weight Weight of the segment
+     * @param blocked True if the segment is blocked
+     */
+    void add(const Crossings &crossings, int si, int c, int sign, double weight, bool blocked)
+    {
+        if (c >= stride)
+            grow(c + 1);
+        if (!weighted)
+        {
+            for (int sj : crossings.neighbors(si))
+                counts[(size_t) sj * stride + c] += sign;
+            return;
+        }
+        for (int sj : crossings.neighbors(si))
+        {
+            const size_t k = (size_t) sj * stride + c;
+            counts[k] += sign;
+            if (blocked)
+                blocks[k] += sign;
+            else
+                weights[k] += sign * weight;
+        }
+    }
+
+    /**
+     * @brief reweight
+     * Change the weight of the segment si, of color c
+     */
+    void reweight(const Crossings &crossings, int si, int c, double old_weight, bool old_blocked, double weight, bool blocked)
+    {
+        if (!weighted)
+            return;
+        for (int sj : crossings.neighbors(si))
+        {
+            const size_t k = (size_t) sj * stride + c;
+            if (old_blocked)
+                blocks[k]--;
+            else
+                weights[k] -= old_weight;
+            if (blocked)
+                blocks[k]++;
+            else
+                weights[k] += weight;
+        }
+    }
+
+    /**
+     * @brief move_color
+     * Move the counts of the color from to the color to, the color from being empty afterwards
+     */
+    void move_color(int from, int to)
+    {
+        if (std::max(from, to) >= stride)
+            grow(std::max(from, to) + 1);
+        for (size_t si = 0; si < (size_t) m; si++)
+        {
+            const size_t k = si * stride;
+            counts[k + to] = counts[k + from];
+            counts[k + from] = 0;
+            if (weighted)
+            {
+                blocks[k + to] = blocks[k + from];
+                weights[k + to] = weights[k + from];
+                blocks[k + from] = 0;
+                weights[k + from] = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief count
+     * @return The number of segments of color c crossing si
+     */
+    int count(int si, int c) const
+    {
+        return c < stride ? counts[(size_t) si * stride + c] : 0;
+    }
+
+    /**
+     * @brief blocked
+     * @return True if a blocked segment of color c crosses si
+     */
+    bool blocked(int si, int c) const
+    {
+        return weighted && c < stride && blocks[(size_t) si * stride + c] > 0;
+    }
+
+    /**
+     * @brief weight
+     * @return The sum of the weights of the segments of color c crossing si. It is
+     * exactly 0 if no segment of color c crosses si, or without the weights
+     */
+    double weight(int si, int c) const
+    {
+        return !weighted || count(si, c) == 0 ? 0 : weights[(size_t) si * stride + c];
+    }
+};
+
+#endif // COLORCOUNTS
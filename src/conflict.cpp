@@ -2,9 +2,13 @@
 
 Conflict::Conflict(Parameters param)
     : Solution(param),
-      queue_count(segments.size(), 0)
+      class_pos(segments.size(), -1),
+      queue_count(segments.size(), 0),
+      board(std::make_shared<Board>())
 {
     generate_intersection_map();
+    color_counts.assign(segments.size(), 1);
+    extend_weight_table(0);
 }
 
 
@@ -22,6 +26,7 @@ void Conflict::init_solution()
             const int c = colorv.at(i);
             classes.at(c).push_back(i);
         }
+        build_colorv();
     }
     else // make a new solution
     {
@@ -32,15 +37,15 @@ void Conflict::init_solution()
             {
                 if (edge_can_be_added_to_graph(si, c))
                 {
-                    classes.at(c).push_back(si);
+                    add_to_class(si, c);
                     is_inserted = true;
                     break;
                 }
             }
             if (!is_inserted)
             {
-                classes.push_back(std::list<int>());
-                classes.back().push_back(si);
+                classes.push_back(std::vector<int>());
+                add_to_class(si, classes.size() - 1);
             }
         }
         std::clog << "We have this many colors: " << classes.size() << std::endl;
@@ -55,23 +60,259 @@ void Conflict::init_solution()
  */
 bool Conflict::crosses(int si, int sj) const
 {
-    const int index_j = sj / 32;
-    const int shift_j = sj % 32;
-    return (crossings[si][index_j] & (1 << shift_j));
+    return crossings->cross(si, sj);
 }
 
 /**
  * @brief Conflict::edge_can_be_added_to_graph
  * @param si
  * @param c
- * @return True if the si-th index can be added to the
+ * @return True if the si-th index can be added to the color c without conflict
  */
 bool Conflict::edge_can_be_added_to_graph(int si, int c) const
 {
-    for (int sj : classes.at(c))
-        if (crosses(si, sj))
-            return false;
-    return true;
+    return color_counts.count(si, c) == 0;
+}
+
+/**
+ * @brief Conflict::add_to_class
+ * Add a segment to a color, keeping `colorv`, its position in the color and the
+ * conflict counts up to date
+ * @param si
+ * @param c
+ */
+void Conflict::add_to_class(int si, int c)
+{
+    class_pos[si] = classes.at(c).size();
+    classes.at(c).push_back(si);
+    colorv[si] = c;
+    color_counts.add(*crossings, si, c, 1, segment_weight(si), is_blocked(si));
+}
+
+/**
+ * @brief Conflict::remove_from_class
+ * Remove a segment from its color, keeping `colorv`, the positions in the color
+ * and the conflict counts up to date. The last segment of the color takes its place
+ * @param si
+ * @param c
+ */
+void Conflict::remove_from_class(int si, int c)
+{
+    std::vector<int> &members = classes.at(c);
+    const int last = members.back();
+    members[class_pos[si]] = last;
+    class_pos[last] = class_pos[si];
+    members.pop_back();
+    colorv[si] = -1;
+    color_counts.add(*crossings, si, c, -1, segment_weight(si), is_blocked(si));
+}
+
+/**
+ * @brief Conflict::add_logged
+ * Add a segment to a color, and record it in the journal
+ */
+void Conflict::add_logged(int si, int c)
+{
+    add_to_class(si, c);
+    journal.push_back(stack_event_t{stack_event_t::added, c, si});
+}
+
+/**
+ * @brief Conflict::remove_logged
+ * Remove a segment from its color, and record it in the journal
+ */
+void Conflict::remove_logged(int si, int c)
+{
+    remove_from_class(si, c);
+    journal.push_back(stack_event_t{stack_event_t::removed, c, si});
+}
+
+/**
+ * @brief Conflict::drop_color
+ * Remove all the segments of the color c, and delete it. The last color takes its
+ * index, so that only the segments of the last color are relabeled. Everything is
+ * recorded in the journal
+ * @param c
+ */
+void Conflict::drop_color(int c)
+{
+    while (!classes.at(c).empty())
+        remove_logged(classes[c].back(), c);
+    const int last = classes.size() - 1;
+    if (c != last)
+    {
+        classes[c].swap(classes[last]);
+        for (int si : classes[c])
+            colorv[si] = c;
+        color_counts.move_color(last, c);
+    }
+    classes.pop_back();
+    journal.push_back(stack_event_t{stack_event_t::dropped, c, -1});
+}
+
+/**
+ * @brief Conflict::restore_color
+ * Undo drop_color: the color at index c goes back to the last index, and c is an
+ * empty color again
+ * @param c
+ */
+void Conflict::restore_color(int c)
+{
+    classes.emplace_back();
+    const int last = classes.size() - 1;
+    if (c != last)
+    {
+        classes[c].swap(classes[last]);
+        for (int si : classes[last])
+            colorv[si] = last;
+        color_counts.move_color(c, last);
+    }
+}
+
+/**
+ * @brief Conflict::segment_weight
+ * @param si
+ * @return The weight of a segment in the score of its color, which increases with
+ * the number of times the segment has been enqueued. It is read from the table of
+ * the weights when possible, and is 0 for the blocked segments
+ */
+double Conflict::segment_weight(int si) const
+{
+    const int q = queue_count[si];
+    if (is_blocked(si))
+        return 0;
+    return (size_t) q < weight_table.size() ? weight_table[q] : pow(q, param.power) + 1;
+}
+
+/**
+ * @brief Conflict::set_power
+ * Change the power of the weights, and recompute the weights
+ * @param power
+ */
+void Conflict::set_power(double power)
+{
+    param.power = power;
+    const size_t size = std::max<size_t>(weight_table.size(), 1);
+    weight_table.clear();
+    extend_weight_table(size - 1);
+    build_color_counts();
+}
+
+/**
+ * @brief Conflict::extend_weight_table
+ * Compute the weights pow(q, power) + 1 of the queue counts up to q
+ * @param q
+ */
+void Conflict::extend_weight_table(int q)
+{
+    for (int k = weight_table.size(); k <= q; k++)
+        weight_table.push_back(pow(k, param.power) + 1);
+}
+
+/**
+ * @brief Conflict::is_blocked
+ * @param si
+ * @return True if the segment has been enqueued too many times, so that the
+ * segments crossing it cannot take its color
+ */
+bool Conflict::is_blocked(int si) const
+{
+    return queue_count[si] >= param.max_queue;
+}
+
+/**
+ * @brief Conflict::increment_queue_count
+ * Count one more enqueuing of a segment, and update its weight in the conflict counts
+ * @param si
+ */
+void Conflict::increment_queue_count(int si)
+{
+    const double old_weight = segment_weight(si);
+    const bool old_blocked = is_blocked(si);
+    queue_count[si]++;
+    if (!is_blocked(si))
+        extend_weight_table(queue_count[si]);
+    if (colorv[si] >= 0)
+        color_counts.reweight(*crossings, si, colorv[si], old_weight, old_blocked, segment_weight(si), is_blocked(si));
+}
+
+/**
+ * @brief Conflict::build_color_counts
+ * Recompute the conflict counts of all the segments, after the colors have been
+ * renumbered or the weights of the segments have changed
+ */
+void Conflict::build_color_counts()
+{
+    color_counts.assign(segments.size(), classes.size());
+    for (unsigned c = 0; c < classes.size(); c++)
+        for (int si : classes[c])
+            color_counts.add(*crossings, si, c, 1, segment_weight(si), is_blocked(si));
+}
+
+/**
+ * @brief Conflict::build_peel_order
+ * Remove the segments one by one, always removing a segment of minimum degree among
+ * the remaining ones, and store the order of removal in peel_order.
+ * The segments are kept in a bucket queue sorted by degree, so that this takes
+ * O(m + E) time, starting from the degrees of the crossings.
+ * peel_bound[i] is the maximum degree of the i first segments at the time of
+ * their removal, so that the segments removed by remove_easy_segs(bound) are
+ * the ones before the first peel_bound[i] >= bound
+ */
+void Conflict::build_peel_order()
+{
+    if (crossings->empty())
+        generate_intersection_map();
+
+    const int m = segments.size();
+    std::vector<int> degree(m), pos(m);
+    int max_degree = 0;
+    for (int si = 0; si < m; si++)
+    {
+        degree[si] = crossings->degree(si);
+        max_degree = std::max(max_degree, degree[si]);
+    }
+    // Sort the segments by degree. bin[d] = position of the first segment of degree d
+    std::vector<int> bin(max_degree + 2, 0);
+    for (int si = 0; si < m; si++)
+        bin[degree[si] + 1]++;
+    for (int d = 1; d <= max_degree + 1; d++)
+        bin[d] += bin[d - 1];
+    peel_order.resize(m);
+    for (int si = 0; si < m; si++)
+    {
+        pos[si] = bin[degree[si]]++;
+        peel_order[pos[si]] = si;
+    }
+    for (int d = max_degree; d > 0; d--)
+        bin[d] = bin[d - 1];
+    bin[0] = 0;
+
+    // The segments before i are removed. Removing the i-th one decrements the
+    // degree of its remaining neighbors, which move to the front of the bucket below
+    peel_bound.resize(m);
+    int bound = 0;
+    for (int i = 0; i < m; i++)
+    {
+        const int si = peel_order[i];
+        bound = std::max(bound, degree[si]);
+        peel_bound[i] = bound;
+        for (int sj : crossings->neighbors(si))
+        {
+            if (degree[sj] <= degree[si])
+                continue;
+            const int first = bin[degree[sj]];
+            const int sk = peel_order[first];
+            if (sk != sj)
+            {
+                std::swap(peel_order[first], peel_order[pos[sj]]);
+                pos[sk] = pos[sj];
+                pos[sj] = first;
+            }
+            bin[degree[sj]]++;
+            degree[sj]--;
+        }
+    }
 }
 
 /**
@@ -89,109 +330,229 @@ bool Conflict::edge_can_be_added_to_graph(int si, int c) const
  * to remove the maximum number of segments.
  * The only condition is that the segments must be later colored in the reverse
  * order.
+ * The order of removal does not depend on the bound, so it is computed once by
+ * build_peel_order, and each bound takes a prefix of it.
  * @param bound We only keep segments that less than `bound` intersecting segments
  */
 void Conflict::remove_easy_segs(int bound)
 {
-    // Compute the degree of each segment
-    std::vector<long> degree(segments.size(), 0); // degree[i] = number of segments intersecting the i-th segment
-    for (unsigned i = 0; i < segments.size(); ++i)
-        for (unsigned j = i+1; j < segments.size(); ++j)
-            if (crosses(i, j))
-            {
-                degree[i]++;
-                degree[j]++;
-            }
-    // Remove segments until all the segments have degree >= bound
-    easy_segs.clear();
-    bool stability = false;
-    while (!stability)
-    {
-        stability = true;
-        // Get the segment with mininimum degree
-        int s = 0; // (index of) the segment to remove (with minimum degree)
-        for (unsigned i = 1; i < degree.size(); ++i)
-            if (degree[i] < degree[s])
-                s = i;
-        if (degree[s] < bound)
-        {
-            // Remove this segment and update the degrees
-            stability = false;
-            degree[s] = std::numeric_limits<long>::max(); // we set its degree to infinity so that we do not remove it again
-            easy_segs.push_back(s);
-            for (unsigned i = 0; i < degree.size(); ++i)
-                if (degree[i] != std::numeric_limits<long>::max() && crosses(i, s))
-                    degree[i]--;
-        }
-    }
+    // The segments removed until all the segments have degree >= bound are the
+    // beginning of the peeling order, up to the first one of degree >= bound
+    if (peel_order.size() != segments.size())
+        build_peel_order();
+    const size_t nb_easy = std::lower_bound(peel_bound.begin(), peel_bound.end(), bound) - peel_bound.begin();
+    easy_segs.assign(peel_order.begin(), peel_order.begin() + nb_easy);
 
     // Remove the easy segments from the solution
-    std::set<long> set_easy_segs(easy_segs.cbegin(), easy_segs.cend());
-    for (unsigned c = 0; c < classes.size(); c++)
-        for (auto it = classes.at(c).begin(); it != classes.at(c).end(); )
+    std::vector<char> is_easy(segments.size(), false);
+    for (long si : easy_segs)
+        is_easy[si] = true;
+    for (std::vector<int> &members : classes) // keep the segments that are not in the list of easy segments
+        members.erase(std::remove_if(members.begin(), members.end(), [&](int si)
         {
-            if (set_easy_segs.count(*it) > 0) // this segment is in the list of easy segments
-                it = classes.at(c).erase(it);
-            else
-                ++it;
-        }
+            return is_easy[si];
+        }), members.end());
+    build_colorv();
 
     std::clog << "Number of easy segments removed: " << easy_segs.size() << std::endl;
 }
 
 /**
  * @brief Conflict::generate_intersection_map
- * Precompute all the intersections
+ * Precompute all the intersections, or load them from the cache directory
  */
 void Conflict::generate_intersection_map()
 {
-    const int m = segments.size();
-    int size = ((m - 1) / 32) + 1;
-    crossings.resize(m);
-    for (int i = 0; i < m; ++i)
-        crossings[i].resize(size);
+    crossings = build_crossings();
+}
 
-    for (int i = 0; i < m; ++i)
+
+/**
+ * @brief Conflict::color
+ * Run the conflict optimizer until the maximum running time. With several threads,
+ * each thread runs its own worker, a copy of this optimizer with its own seed and
+ * settings, and the workers share the crossings and the best solution.
+ * In the portfolio mode, there is at least one worker per power of the power loop
+ */
+void Conflict::color()
+{
+    board->graph_file = graph_file_name();
+    std::vector<std::unique_ptr<Conflict>> workers;
+    if (!param.resume.empty()) // restart all the workers from a checkpoint
     {
-        const int index_i = i / 32;
-        const int shift_i = i % 32;
-        for (int j = i + 1; j < m; ++j) {
+        const std::vector<std::string> states = read_checkpoint(param.resume);
+        board->snapshots.assign(states.size(), "");
+        load_state(states.at(0));
+        for (unsigned w = 1; w < states.size(); w++)
+        {
+            workers.push_back(std::unique_ptr<Conflict>(new Conflict(*this)));
+            workers.back()->load_state(states.at(w));
+        }
+        std::clog << "Resuming " << states.size() << " workers from " << param.resume
+                  << " after " << elapsed_sec() << " seconds, best solution of size " << board->best << std::endl;
+    }
+    else
+    {
+        if (!param.solution_name.empty())
+            Solution::read(param.solution_name);
+        init_solution();
 
-            if (segments[i].cross(segments[j]))
-            {
-                const int index_j = j / 32;
-                const int shift_j = j % 32;
-                crossings[i][index_j] = crossings[i][index_j] | (1 << shift_j);
-                crossings[j][index_i] = crossings[j][index_i] | (1 << shift_i);
-            }
+        if (!clique.empty() && clique.size() == classes.size())
+        {
+            std::cout << "File is optimal" << std::endl;
+            return;
+        }
+
+        board->best = classes.size();
+        board->colorv = colorv;
+        board->improvements.assign(param.power_loop.size(), 0);
+        board->last_improvement.assign(param.power_loop.size(), 0);
+
+        int nb_workers = param.threads;
+        if (portfolio())
+            nb_workers = std::max<int>(nb_workers, param.power_loop.size());
+        board->snapshots.assign(nb_workers, "");
+        configure_worker(0);
+        for (int w = 1; w < nb_workers; w++)
+        {
+            workers.push_back(std::unique_ptr<Conflict>(new Conflict(*this)));
+            workers.back()->configure_worker(w);
         }
     }
+
+    std::vector<std::thread> pool;
+    for (auto &worker : workers)
+        pool.push_back(std::thread(&Conflict::search, worker.get()));
+    search();
+    for (std::thread &th : pool)
+        th.join();
 }
 
+/**
+ * @brief Conflict::search
+ * Optimize the solution until the maximum running time, publishing every improvement
+ */
+void Conflict::search()
+{
+    while (elapsed_sec() < param.max_run_time)
+    {
+        // a resumed worker continues from where it stopped, without removing the easy segments again
+        const bool improved = resumed ? improve() : optimize();
+        resumed = false;
+        if (improved)
+        {
+            build_colorv();
+            publish();
+        }
+    }
+}
 
-void Conflict::color()
+/**
+ * @brief Conflict::portfolio
+ * @return True if the powers of the power loop are run at the same time by
+ * different workers, instead of one after the other
+ */
+bool Conflict::portfolio() const
 {
-    if (!param.solution_name.empty())
-        Solution::read(param.solution_name);
-    init_solution();
+    return param.loop && param.threads > 1 && !param.power_loop.empty();
+}
 
-    if (!clique.empty() && clique.size() == classes.size())
+/**
+ * @brief Conflict::configure_worker
+ * Give its own seed and settings to a worker. Each worker uses another power of
+ * the power loop, and the noise is increased once all the powers are taken.
+ * Outside of the portfolio mode, worker 0 keeps the parameters
+ * @param w Index of the worker
+ */
+void Conflict::configure_worker(int w)
+{
+    worker = w;
+    noise.seed(w);
+    const int n = param.power_loop.size();
+    if (portfolio())
     {
-        std::cout << "File is optimal" << std::endl;
-        return;
+        power_index = w % n;
+        param.noise_var *= 1 + 0.5 * (w / n);
+        set_power(param.power_loop.at(power_index));
+    }
+    else if (w > 0 && n > 0)
+    {
+        param.noise_var *= 1 + 0.5 * ((w - 1) / n);
+        set_power(param.power_loop.at((w - 1) % n));
     }
+    last_progress = elapsed_sec();
+    std::clog << "Worker " << worker << ": power " << param.power << ", noise_var " << param.noise_var << std::endl;
+}
 
-    while (elapsed_sec() < param.max_run_time)
+/**
+ * @brief Conflict::reassign
+ * In the portfolio mode, move a worker which did not improve the best solution
+ * during `loop_time` seconds to the power which improved it the most times
+ */
+void Conflict::reassign()
+{
+    if (power_index < 0 || elapsed_sec() - last_progress < param.loop_time)
+        return;
+    last_progress = elapsed_sec();
+
+    std::lock_guard<std::mutex> lock(board->mutex);
+    int best_index = power_index;
+    for (unsigned p = 0; p < board->improvements.size(); p++)
+        if (board->improvements[p] > board->improvements[best_index]
+                || (board->improvements[p] == board->improvements[best_index] && board->last_improvement[p] > board->last_improvement[best_index]))
+            best_index = p;
+    if (best_index == power_index || board->improvements[best_index] == 0)
+        return;
+    std::clog << "Worker " << worker << " made no progress with power " << param.power
+              << ", switching to power " << param.power_loop.at(best_index) << std::endl;
+    power_index = best_index;
+    set_power(param.power_loop.at(power_index));
+}
+
+/**
+ * @brief Conflict::publish
+ * Write the solution if it is better than the best solution of all the workers
+ */
+void Conflict::publish()
+{
+    std::lock_guard<std::mutex> lock(board->mutex);
+    if ((int) classes.size() >= board->best)
+        return;
+    board->best = classes.size();
+    board->colorv = colorv;
+    if (power_index >= 0)
     {
-        if (optimize())
-        {
-            build_colorv();
-            std::cout << "Writing solution of size " << classes.size() << std::endl;
-            write_sol("conflict");
-            //Also write the new data point for the paper graph
-            add_data_point_to_graph_file();
-        }
+        board->improvements.at(power_index)++;
+        board->last_improvement.at(power_index) = elapsed_sec();
     }
+    last_progress = elapsed_sec();
+    std::cout << "Writing solution of size " << classes.size();
+    if (param.threads > 1)
+        std::cout << " (worker " << worker << ")";
+    std::cout << std::endl;
+    write_sol("conflict");
+    //Also write the new data point for the paper graph
+    add_data_point_to_graph_file();
+}
+
+/**
+ * @brief Conflict::adopt_best
+ * Replace the solution by the best solution of all the workers, if it is better
+ * @return True if the solution has been replaced
+ */
+bool Conflict::adopt_best()
+{
+    std::lock_guard<std::mutex> lock(board->mutex);
+    if (board->best >= (int) classes.size())
+        return false;
+    colorv = board->colorv;
+    classes.assign(board->best, std::vector<int>());
+    for (std::size_t i = 0; i < colorv.size(); ++i)
+        classes.at(colorv[i]).push_back(i);
+    build_colorv();
+    easy_segs.clear();
+    std::clog << "Worker " << worker << " adopts the best solution, of size " << classes.size() << std::endl;
+    return true;
 }
 
 /**
@@ -201,14 +562,33 @@ void Conflict::color()
  */
 bool Conflict::optimize()
 {
-    distribution = std::normal_distribution<double>(param.noise_mean, param.noise_var);
+    noise.set(param.noise_mean, param.noise_var);
 
     if (param.easy)
         remove_easy_segs(classes.size() - 1);
 
+    return improve();
+}
+
+/**
+ * @brief Conflict::improve
+ * Shuffle the solution and run the conflict optimizer until the number of colors
+ * decreases, or until the maximum running time
+ * @return True if the number of colors decreased
+ */
+bool Conflict::improve()
+{
     while (true)
     {
-        shuffle(); // shuffle the solution (and improve it maybe)
+        if (attempt_color < 0) // a worker resumed during an attempt continues it first
+        {
+            if (adopt_best()) // another worker found a better solution
+                return false;
+            reassign();
+            checkpoint();
+
+            shuffle(); // shuffle the solution (and improve it maybe)
+        }
 
         long old_size = classes.size();
         long new_size = 0;
@@ -246,6 +626,7 @@ bool Conflict::shuffle(int n)
     while (count < n)
     {
         std::clog << "size of solution: " << size << "\t(count=" << count << ")" << std::endl;
+        checkpoint();
         shuffle_once();
         old_size = size;
         size = classes.size();
@@ -279,10 +660,11 @@ bool Conflict::shuffle(int n)
 void Conflict::shuffle_once()
 {
     // order classes from smallest to largest
-    sort(classes.begin(), classes.end(), [](const std::list<int> & c1, const std::list<int> & c2) -> bool
+    sort(classes.begin(), classes.end(), [](const std::vector<int> & c1, const std::vector<int> & c2) -> bool
     {
         return c1.size() < c2.size();
     });
+    build_colorv();
 
     // for each class, for each of its segments, we try to move the segment to another class
     for (unsigned c = 0; c < classes.size(); c++)
@@ -291,6 +673,7 @@ void Conflict::shuffle_once()
         if (classes.at(c).empty())
         {
             classes.erase(std::next(classes.begin(), c));
+            build_colorv();
             c--;
 //            std::clog << "one color removed; current size = " << classes.size() << std::endl;
         }
@@ -307,6 +690,7 @@ void Conflict::reset_queue_count()
     // Put clique segments weight to infty
     for (int si : clique)
         queue_count.at(si) = std::numeric_limits<int>::max();
+    build_color_counts();
 }
 
 /**
@@ -319,7 +703,7 @@ void Conflict::add_easy_segs()
     if (!param.easy) // Test whether or not we use easy
         return;
 
-    if (crossings.empty())
+    if (crossings->empty())
         generate_intersection_map();
 
     std::clog << "There are " << easy_segs.size() << " edges to greedy color" << std::endl;
@@ -332,7 +716,7 @@ void Conflict::add_easy_segs()
         {
             if (edge_can_be_added_to_graph(*it, c))
             {
-                classes.at(c).push_back(*it);
+                add_to_class(*it, c);
                 colored = true;
             }
         }
@@ -342,40 +726,58 @@ void Conflict::add_easy_segs()
             exit(EXIT_FAILURE);
         }
     }
+    // The easy segments are now part of the solution, so that a second call does not color them twice
+    easy_segs.clear();
 }
 
+/**
+ * @brief Conflict::conflict_dfs_optim_solution
+ * Try to remove the colors one by one, from the smallest one, with the conflict
+ * optimizer. The attempt in progress (the dropped color and the queues) is kept
+ * in the optimizer, so that it can be saved by a checkpoint, and a worker resumed
+ * from a checkpoint continues its attempt before trying the next colors
+ * @param one_shot True to stop after the first failed attempt
+ */
 int Conflict::conflict_dfs_optim_solution(bool one_shot)
 {
     int DEBUG_COUNT = 0;
 
-    // order classes from smallest to largest
-    std::sort(classes.begin(), classes.end(), [](const std::list<int> & c1, const std::list<int> & c2) -> bool
+    if (attempt_color < 0)
     {
-        return c1.size() < c2.size();
-    });
+        // order classes from smallest to largest
+        std::sort(classes.begin(), classes.end(), [](const std::vector<int> & c1, const std::vector<int> & c2) -> bool
+        {
+            return c1.size() < c2.size();
+        });
+        build_colorv();
+    }
 
     //for each color class, for each of its segments, we try to move the edge to another color class
-    for (int c = 0; c < classes.size(); c++)
+    for (int c = std::max(attempt_color, 0); c < (int) classes.size(); c++)
     {
-        move_segments(c);
-        if (classes.at(c).empty())
+        if (attempt_color < 0)
+            move_segments(c);
+        if (attempt_color < 0 && classes.at(c).empty())
         {
             classes.erase(std::next(classes.begin(), c));
+            build_colorv();
             c--;
         }
         else
         {
-            std::clog << "entering conflict solver for the " << ++DEBUG_COUNT << " time" << std::endl;
-            // We did not manage to move every segment. We start the conflict solver
-            std::list<int> queue;
-            std::vector<std::list<int>> temp_sol; // This is a save. In case we do not succeed to improve, we'll restore the save
-            copy_sol(classes, temp_sol);
-
-            // We move the remaining edges to the queue, and delete the color
-            for (int si : classes.at(c))
-                queue.push_back(si);
-//            long first_edge_id_of_it = classes.at(c).front(); // @todo Why?
-            classes.erase(std::next(classes.begin(), c));
+            if (attempt_color < 0)
+            {
+                std::clog << "entering conflict solver for the " << ++DEBUG_COUNT << " time" << std::endl;
+                // We did not manage to move every segment. We start the conflict solver.
+                // The journal is empty: in case we do not succeed to improve, we undo all its moves
+
+                // We move the remaining edges to the queue, and delete the color
+                queue.assign(classes.at(c).begin(), classes.at(c).end());
+                dfs_queue.clear();
+                attempt_color = c;
+                drop_color(c);
+                reset_queue_count();
+            }
 
             // Now, for each segment in the queue, we move it to the color class with
             // least conflict, and move the conflicting segments to the queue.
@@ -383,23 +785,26 @@ int Conflict::conflict_dfs_optim_solution(bool one_shot)
             // such that we would re-queue a segment (put into the queue a segment
             // that already went into the queue this generation)
             bool successfull_removal = true;
-            reset_queue_count();
-            std::list<int> dfs_queue;
             while (!queue.empty() || !dfs_queue.empty())
             {
                 // test for stopping running
                 if (elapsed_sec() > param.max_run_time)
                 {
-                    exit(0);
+                    rollback(0);
+                    queue.clear();
+                    dfs_queue.clear();
+                    attempt_color = -1;
+                    return 0;
                 }
+                checkpoint();
                 // Test for switching params
-                if (param.loop && elapsed_sec() > param.loop_time * (param.loop_index + 1))
+                if (param.loop && !portfolio() && elapsed_sec() > param.loop_time * (param.loop_index + 1))
                 {
                     std::clog << "Switching param" << std::endl;
-                    for (int power : param.power_loop)
+                    for (double power : param.power_loop)
                         std::clog << power << std::endl;
                     param.loop_index++;
-                    param.power = param.power_loop.at(param.loop_index % 5);
+                    set_power(param.power_loop.at(param.loop_index % param.power_loop.size()));
                     std::clog << "New power is: " << param.power << std::endl;
                 }
 
@@ -407,16 +812,12 @@ int Conflict::conflict_dfs_optim_solution(bool one_shot)
                 if (!dfs_queue.empty()) // @todo  I do not understand this well
                 {
                     cur_seg = dfs_queue.front();
-                    std::list<int> solo;
-                    solo.push_back(cur_seg);
-                    std::list<stack_event_t> stack;
 
                     //We try to put it, if we succeed good, else it goes to the conflict solver
-                    std::list<int> forbidden;
                     int depth = 3;
                     if (queue.size() < 3)
                         depth = (queue.size() == 1) ? 5 : 7;
-                    if (param.dfs && dfsOptimize(solo, forbidden, 3, depth, stack) == 0)
+                    if (param.dfs && dfs(cur_seg, depth) == 0)
                     {
                         // we succeeded
                         dfs_queue.pop_front();
@@ -437,32 +838,36 @@ int Conflict::conflict_dfs_optim_solution(bool one_shot)
 
                 // Find the color of least conflict
                 int best_c;
-                std::list<int> conflicting_segs;
+                std::vector<int> conflicting_segs;
                 if (best_color(cur_seg, best_c, conflicting_segs))
                 {
                     // move the conflicting segments from the color class to the DFS queue
                     for (int si : conflicting_segs)
                     {
                         dfs_queue.push_back(si);
-                        classes.at(best_c).remove(si);
+                        remove_logged(si, best_c);
                     }
                     // add cur_seg to the best color class
-                    classes.at(best_c).push_back(cur_seg);
+                    add_logged(cur_seg, best_c);
 
                     //flag cur_seg as untouchable from now on
-                    queue_count[cur_seg]++;// = queue_count[cur_seg.id] + 1;
+                    increment_queue_count(cur_seg);
                 }
                 else
                 {
                     // all graphs have conflicts with an old queued segment
-                    // Stop computation, and restore to temp_sol
+                    // Stop computation, and restore the solution before the attempt
                     std::cout << "MAX RUN TIME (" << param.max_queue << ") REACHED" << std::endl;
 
-                    copy_sol(temp_sol, classes);
+                    rollback(0);
+                    queue.clear();
+                    dfs_queue.clear();
                     successfull_removal = false;
                     break;
                 }
             }
+            journal.clear();
+            attempt_color = -1;
             if (!successfull_removal)
             {
                 if (one_shot)
@@ -505,79 +910,84 @@ void Conflict::move_segments(unsigned c)
     }
     for (const auto &pair : moving_segs)
     {
-        classes.at(c).remove(pair.first);
-        classes.at(pair.second).push_back(pair.first);
+        remove_from_class(pair.first, c);
+        add_to_class(pair.first, pair.second);
     }
 }
 
 
+/**
+ * @brief Conflict::dfs
+ * Try to add a segment to a color with dfsOptimize, starting with no forbidden segment
+ * @param seg
+ * @param depth Maximum depth in the tree of possibility to reach
+ * @return 0 if we succeeded, -1 otherwise
+ */
+int Conflict::dfs(int seg, int depth)
+{
+    if (++dfs_epoch == 0) // the stamps wrapped around
+    {
+        std::fill(forbidden_stamp.begin(), forbidden_stamp.end(), 0);
+        dfs_epoch = 1;
+    }
+    forbidden_stamp.resize(segments.size(), 0);
+    if ((int) dfs_levels.size() <= depth)
+        dfs_levels.resize(depth + 1);
+    return dfsOptimize(&seg, 1, 3, depth);
+}
+
 /**
  * @brief Conflict::dfsOptimize
  * Try a limited Depth First Search in the tree of possibilities in order to
  * add a segment (or several during recursive calls)
  * to a color without having to queue any other edges.
- * If we failed, the solution remains unchanged, otherwise the colors are changed
- * @param todo List of segments that need to find a color
- * @param forbidden List of segments that we cannot intersect and move to the recursive todo list
+ * If we failed, the solution remains unchanged, otherwise the colors are changed.
+ * The changes are recorded in the journal, the candidate colors of each depth
+ * are kept in the buffers of this depth, and the segments that we cannot move
+ * (the ones we are adding in the calls above) are stamped with the epoch of the
+ * search, so that no memory is allocated once the buffers are large enough
+ * @param todo Segments that need to find a color
+ * @param nb_todo Number of segments in todo
  * @param breadth Maximum number of intersection within a color allowed
  * @param depth Maximum depth in the tree of possibility to reach
- * @param changes Stack of all the changes that have been made to reach the current state of the solution
+ * @return 0 if we succeeded, -1 otherwise
  */
-int Conflict::dfsOptimize(std::list<int> &todo, std::list<int> &forbidden, int breadth, int depth, std::list<stack_event_t> &changes)
+int Conflict::dfsOptimize(const int *todo, int nb_todo, int breadth, int depth)
 {
-    std::list<int> copy_forbidden = forbidden;
-
-    if (todo.size() == 0)
+    if (nb_todo == 0)
         return 0;
 
     if (depth == 1)
         breadth = 0;
 
+    const size_t start = journal.size();
+    dfs_level_t &level = dfs_levels.at(depth);
+
     // All edges in todo must be colored
-    for (int e : todo)
+    for (int k = 0; k < nb_todo; k++)
     {
-        std::list<std::pair<int, std::list<int>>> conflict_colors; // list of pairs (color, list of segments)
-        get_colors_with_small_conflict_number(e, breadth, forbidden, conflict_colors);
+        const int e = todo[k];
+        get_colors_with_small_conflict_number(e, breadth, level);
         bool has_been_breaked = false;
-        for (const auto &conflicts_c : conflict_colors)
+        for (size_t i = 0; i < level.colors.size(); i++)
         {
-            classes.at(conflicts_c.first).push_back(e); // @todo Loic did a push_front
+            const int c = level.colors[i];
+            const int *conflicts = level.segs.data() + level.first[i];
+            const int nb_conflicts = level.first[i + 1] - level.first[i];
 
-            remove_edges_from_color(conflicts_c.first, conflicts_c.second);
-            std::list<int> subtodo = conflicts_c.second;
+            const size_t candidate = journal.size();
+            add_logged(e, c);
+            for (int j = 0; j < nb_conflicts; j++)
+                remove_logged(conflicts[j], c);
 
-            std::list<stack_event_t> status;
-            copy_forbidden.push_back(e);
-            int ret = dfsOptimize(subtodo, copy_forbidden, breadth, depth - 1, status);
-            copy_forbidden.pop_back();
+            forbidden_stamp[e] = dfs_epoch;
+            int ret = dfsOptimize(conflicts, nb_conflicts, breadth, depth - 1);
+            forbidden_stamp[e] = 0;
 
             if (ret == -1)
-            {
-                std::list<int> edge_to_remove;
-                edge_to_remove.push_back(e);
-                remove_edges_from_color(conflicts_c.first, edge_to_remove);
-                add_edges_to_color(conflicts_c.first, conflicts_c.second);
-            }
+                rollback(candidate);
             else
             {
-                stack_event_t change;
-                change.was_it_removed = false;
-                change.was_it_added = true;
-                change.was_added_to = conflicts_c.first;
-                change.edge = e;
-                changes.push_back(change);
-
-                for (int cf: conflicts_c.second) {
-                    stack_event_t change;
-                    change.was_it_removed = true;
-                    change.was_it_added = false;
-                    change.was_removed_from = conflicts_c.first;
-                    change.edge = cf;
-                    changes.push_back(change);
-                }
-                for (stack_event_t &st: status) {
-                    changes.push_back(st);
-                }
                 has_been_breaked = true;
                 break;
             }
@@ -585,7 +995,7 @@ int Conflict::dfsOptimize(std::list<int> &todo, std::list<int> &forbidden, int b
         // No possibility, abort
         if (!has_been_breaked)
         {
-            undo_changes(changes);
+            rollback(start);
             return -1;
         }
     }
@@ -595,157 +1005,140 @@ int Conflict::dfsOptimize(std::list<int> &todo, std::list<int> &forbidden, int b
 
 /**
  * @brief Conflict::get_colors_with_small_conflict_number
- * Return all the colors that have a number of conflict less or equal than breadth.
- * The colors are returned in conflict_colors, that stores, the color, and the
- * list of segments that intersects
+ * Return all the colors that have a number of conflict less or equal than breadth,
+ * and no conflict with a forbidden segment.
+ * The colors are returned in level.colors, and the segments of the i-th color
+ * crossing e in level.segs[level.first[i]..level.first[i+1]).
+ * The number of conflicts of each color is read from the conflict counts, and
+ * the segments of the chosen colors are found by going through the segments crossing e
  * @param e The segment
  * @param breadth Max number of conflicts
- * @param forbidden List of forbidden edges, we can't intersect those
- * @param conflict_colors List of the colors that cross e less than breadth time
+ * @param level Buffers of the current depth
  */
-void Conflict::get_colors_with_small_conflict_number(int e, int breadth, std::list<int> &forbidden, std::list<std::pair<int, std::list<int> > > &conflict_colors)
+void Conflict::get_colors_with_small_conflict_number(int e, int breadth, dfs_level_t &level)
 {
+    level.colors.clear();
+    level.first.assign(1, 0);
+    color_slot.resize(classes.size());
+    bool has_conflicts = false;
     for (unsigned c = 0; c < classes.size(); c++)
     {
-        std::list<int> intersectors;
-        if (get_intersectors(c, e, intersectors, breadth, forbidden) != -1)
-            conflict_colors.push_back(std::make_pair(c, intersectors));
-    }
-}
-
-/**
- * @brief Conflict::get_intersectors
- * Compute the list of edge intersecting e in color.
- * @param c The color
- * @param e The segment
- * @param intersectors The list of edges from color that intersect e
- * @param max_intersections Maximum number of allowed intersections before
- * stopping computation and returning -1
- * @param forbidden List of forbidden edges that we are not allowed to intersect
- * @return -1 if there is more than max_intersections intersections or
- * if at least 1 forbidden edge is intersected by e in color. 0 otherwise
- */
-int Conflict::get_intersectors(int c, int e, std::list<int> &intersectors, int max_intersections, std::list<int> &forbidden)
-{
-    int count = 0;
-    for (int si : classes.at(c))
-    {
-        if (crosses(e, si))
+        const int count = color_counts.count(e, c);
+        color_slot[c] = -1;
+        if (count <= breadth)
         {
-            count++;
-            if (count > max_intersections)
-                return -1;
-            if (in_list(si, forbidden))
-                return -1;
-            intersectors.push_back(si);
+            color_slot[c] = level.colors.size();
+            level.colors.push_back(c);
+            level.first.push_back(level.first.back() + count);
+            has_conflicts = has_conflicts || count > 0;
         }
     }
-    return 0;
-}
-
-/**
- * @brief Conflict::in_list
- * @param i
- * @param l
- * @return True if `i` appears in `l`
- */
-bool Conflict::in_list(int i, const std::list<int> &l) const
-{
-    for (int j : l)
-        if (i == j)
-            return true;
-    return false;
-}
-
-/**
- * @brief Conflict::remove_edges_from_color
- * Remove all the edges in conflicts from color
- * @param color
- * @param conflicts
- * @return
- * @todo I SHOULD BETTER USE A SET
- */
-void Conflict::remove_edges_from_color(int color, const std::list<int> &conflicts)
-{
-    for (int seg :conflicts)
-        classes.at(color).remove(seg);
-}
+    level.segs.resize(level.first.back());
+    if (!has_conflicts)
+        return;
 
+    // Fill the segments of the chosen colors, and drop the colors of the forbidden segments
+    slot_fill.assign(level.first.begin(), level.first.end() - 1);
+    slot_dropped.assign(level.colors.size(), false);
+    for (int si : crossings->neighbors(e))
+    {
+        const int c = colorv[si];
+        if (c < 0 || color_slot[c] < 0)
+            continue;
+        const int slot = color_slot[c];
+        if (forbidden_stamp[si] == dfs_epoch)
+            slot_dropped[slot] = true;
+        else
+            level.segs[slot_fill[slot]++] = si;
+    }
 
-int Conflict::add_edges_to_color(int color, const std::list<int> &conflicts)
-{
-    for (int si : conflicts) {
-        classes.at(color).push_back(si);
-        // std::clog << "Pushing: " << si << std::endl;
+    size_t kept = 0, nb_segs = 0;
+    for (size_t slot = 0; slot < level.colors.size(); slot++)
+    {
+        if (slot_dropped[slot])
+            continue;
+        const int begin = level.first[slot], end = level.first[slot + 1];
+        level.colors[kept] = level.colors[slot];
+        level.first[kept] = nb_segs;
+        for (int j = begin; j < end; j++)
+            level.segs[nb_segs++] = level.segs[j];
+        kept++;
     }
-    return 0;
+    level.colors.resize(kept);
+    level.first.resize(kept + 1);
+    level.first[kept] = nb_segs;
+    level.segs.resize(nb_segs);
 }
 
 /**
- * @brief Conflict::undo_changes
- * Undo all stacked events and pop them out of the stack
- * @param changes
- * @return
+ * @brief Conflict::rollback
+ * Undo the events of the journal after the first `size` ones, and pop them out of the journal.
+ * This takes a time proportional to the number of moves undone
+ * @param size
  */
-int Conflict::undo_changes(std::list<stack_event_t> &changes)
+void Conflict::rollback(size_t size)
 {
-    while (changes.size() != 0) {
-        undo_change(changes.back());
-        changes.pop_back();
+    while (journal.size() > size)
+    {
+        undo_change(journal.back());
+        journal.pop_back();
     }
-    return 0;
 }
 
-int Conflict::undo_change(stack_event_t &evt)
+void Conflict::undo_change(const stack_event_t &evt)
 {
-    if (evt.was_it_added) {
-        //cout << "was added" << endl;
-        undo_added(evt);
-    } else {
-        //cout << "was removed" << endl;
-        undo_removed(evt);
+    switch (evt.kind)
+    {
+    case stack_event_t::added:
+        remove_from_class(evt.edge, evt.color);
+        break;
+    case stack_event_t::removed:
+        add_to_class(evt.edge, evt.color);
+        break;
+    case stack_event_t::dropped:
+        restore_color(evt.color);
+        break;
     }
-    return 0;
-}
-
-
-
-int Conflict::undo_added(stack_event_t &evt)
-{
-    for (auto it = classes.at(evt.was_added_to).begin(); it != classes.at(evt.was_added_to).end(); ++it)
-        if (*it == evt.edge)
-        {
-            classes.at(evt.was_added_to).erase(it);
-            return 0;
-        }
-    return -1;
-}
-
-
-int Conflict::undo_removed(stack_event_t &evt)
-{
-    //we have to add it back
-    classes.at(evt.was_removed_from).push_back(evt.edge);
-    return 0;
 }
 
 /**
  * @brief Conflict::build_colorv
- * Build the solution
+ * Build the solution, the positions of the segments in their colors and the
+ * conflict counts. The segments which are not in any
+ * color are labeled -1
  */
 void Conflict::build_colorv()
 {
+    std::fill(colorv.begin(), colorv.end(), -1);
     for (unsigned int c = 0; c < classes.size(); c++)
-        for (int vi : classes[c])
-            colorv[vi] = c;
+        for (unsigned int k = 0; k < classes[c].size(); k++)
+        {
+            colorv[classes[c][k]] = c;
+            class_pos[classes[c][k]] = k;
+        }
+    build_color_counts();
 }
 
 
 int Conflict::add_data_point_to_graph_file()
 {
     std::pair<double, int> data_point(elapsed_sec(), classes.size());
-    data_points.push_back(data_point);
+    board->data_points.push_back(data_point);
+
+    std::ofstream file(board->graph_file);
+    for (const auto &pr : board->data_points)
+        file << pr.first << " " << pr.second << std::endl;
 
+    file.close();
+    return 0;
+}
+
+/**
+ * @brief Conflict::graph_file_name
+ * @return The name of the file of the data points, made from the parameters
+ */
+std::string Conflict::graph_file_name() const
+{
     std::string info = (param.info_name.empty()) ? "1" : "0";
 
     std::string fn;
@@ -805,77 +1198,386 @@ int Conflict::add_data_point_to_graph_file()
         }
     }
 
-    std::ofstream file(fn);
-    for (const auto &pr : data_points)
-        file << pr.first << " " << pr.second << std::endl;
-
-    file.close();
-    return 0;
+    return fn;
 }
 
 /**
  * @brief Conflict::best_color
  * Find the color with the smallest score. This is the color in which the edge
  * will be added by the conflict optimizer.
+ * The score of each color is read from the conflict counts
  * @param seg The segment that we want to insert in the solution
- * @param queue_count The number of times that each edge has already been
- * in the queue. (Used to compute the score)
  * @param best_c
  * @param conflicting_segs The chosen color the put the edge_to_place
  * @return False if all subgraphs have an intersection with an already been
  * queued edge
- * @todo We put the queue_count vector in the class
  */
-bool Conflict::best_color(int seg, int &best_c, std::list<int> &conflicting_segs)
+bool Conflict::best_color(int seg, int &best_c, std::vector<int> &conflicting_segs)
 {
-    double min_conflict = param.max_queue * segments.size();
+    // Sum of the weights of the segments of each color crossing seg, or -1 if
+    // one of them has been queued too many times
+    color_weight.resize(classes.size());
+    for (unsigned c = 0; c < classes.size(); c++)
+        color_weight[c] = color_counts.blocked(seg, c) ? -1 : color_counts.weight(seg, c);
 
+    double min_conflict = param.max_queue * segments.size();
     for (unsigned c = 0; c < classes.size(); c++)
     {
-        double conflict_count = 0;
-        std::list<int> candidate_edges;
         // some gaussian noise, but not stupidly low noise, or even worse: negative noise
-        double noise = distribution(generator);
+        double noise = this->noise();
         while (noise < 0.001)
-            noise = distribution(generator);
-        double min_conflict_noised = min_conflict / noise;
-        for (int si : classes.at(c))
+            noise = this->noise();
+        if (color_weight[c] >= 0 && color_weight[c] * noise < min_conflict)
         {
-            if (crosses(seg, si))
-            {
-                if (queue_count[si] >= param.max_queue)
-                {
-                    //It s no good
-                    conflict_count = min_conflict_noised + 1;
-                    break;
-                }
-                else
-                {
-                    conflict_count = conflict_count + pow(queue_count[si], param.power) + 1;
-                    if (conflict_count >= min_conflict_noised)
-                        break;
-                    candidate_edges.push_back(si);
-                }
-            }
+            min_conflict = color_weight[c] * noise;
+            best_c = c;
         }
+    }
 
-        if (conflict_count * noise < min_conflict)
-        {
-            min_conflict = conflict_count * noise;
-            best_c = c;
-            conflicting_segs.clear();
-            for (int si : candidate_edges)
+    if (min_conflict >= param.max_queue * segments.size())
+        return false;
+
+    conflicting_segs.clear();
+    if (color_counts.count(seg, best_c) > 0)
+        for (int si : crossings->neighbors(seg))
+            if (colorv[si] == best_c)
                 conflicting_segs.push_back(si);
+    return true;
+}
+
+
+template <typename T>
+static void write_value(std::ostream &out, const T &value)
+{
+    out.write((const char *) &value, sizeof(T));
+}
+
+template <typename T>
+static void write_vector(std::ostream &out, const std::vector<T> &values)
+{
+    write_value<uint64_t>(out, values.size());
+    out.write((const char *) values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+static T read_value(std::istream &in)
+{
+    T value{};
+    in.read((char *) &value, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief remaining
+ * @return The number of bytes left to read in the stream
+ */
+static uint64_t remaining(std::istream &in)
+{
+    if (!in)
+        return 0;
+    const std::streampos pos = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(pos);
+    return in && end > pos ? end - pos : 0;
+}
+
+/**
+ * @brief read_vector
+ * Read a vector written by write_vector. The stream fails, and the vector is
+ * empty, if the vector has more than max_size elements or is longer than the rest
+ * of the stream, so that nothing is allocated from a corrupted size
+ * @param in
+ * @param max_size Maximum number of elements
+ */
+template <typename T>
+static std::vector<T> read_vector(std::istream &in, uint64_t max_size)
+{
+    const uint64_t size = read_value<uint64_t>(in);
+    if (!in || size > max_size || size > remaining(in) / sizeof(T))
+    {
+        in.setstate(std::ios::failbit);
+        return std::vector<T>();
+    }
+    std::vector<T> values(size);
+    in.read((char *) values.data(), values.size() * sizeof(T));
+    return values;
+}
+
+/**
+ * @brief in_range
+ * @return True if all the values are in [low, high)
+ */
+template <typename T>
+static bool in_range(const std::vector<T> &values, T low, T high)
+{
+    return std::all_of(values.begin(), values.end(), [low, high](T v) { return low <= v && v < high; });
+}
+
+/**
+ * @brief Conflict::save_state
+ * Write the state of a worker: its settings, its solution without the easy
+ * segments, the easy segments and the state of the noise. During an attempt to
+ * remove a color, the solution written is the one before the attempt (the journal
+ * being undone on a copy of the colors), followed by the attempt: the dropped
+ * color, the current colors, the queues and the queue counts
+ * @param out
+ */
+void Conflict::save_state(std::ostream &out) const
+{
+    static_assert(std::is_trivially_copyable<Noise>::value, "the noise is saved as raw bytes");
+    write_value<int32_t>(out, worker);
+    write_value<int32_t>(out, power_index);
+    write_value<double>(out, last_progress);
+    write_value<double>(out, param.power);
+    write_value<double>(out, param.noise_var);
+    write_value<int64_t>(out, param.loop_index);
+
+    std::vector<int> before = colorv;
+    int nb_colors = classes.size();
+    for (auto evt = journal.rbegin(); evt != journal.rend(); ++evt)
+        switch (evt->kind)
+        {
+        case stack_event_t::added:
+            before[evt->edge] = -1;
+            break;
+        case stack_event_t::removed:
+            before[evt->edge] = evt->color;
+            break;
+        case stack_event_t::dropped: // the color at index evt->color goes back to the last index
+            for (int &c : before)
+                if (c == evt->color)
+                    c = nb_colors;
+            nb_colors++;
+            break;
         }
+    std::vector<std::vector<int>> members(nb_colors);
+    if (journal.empty())
+        members = classes;
+    else
+        for (unsigned si = 0; si < before.size(); si++)
+            if (before[si] >= 0)
+                members[before[si]].push_back(si);
+    write_value<uint64_t>(out, members.size());
+    for (const std::vector<int> &color : members)
+        write_vector(out, color);
+    write_vector(out, std::vector<long>(easy_segs.begin(), easy_segs.end()));
+    write_value(out, noise);
+
+    write_value<int32_t>(out, attempt_color);
+    if (attempt_color >= 0)
+    {
+        write_vector(out, colorv);
+        write_vector(out, std::vector<int>(queue.begin(), queue.end()));
+        write_vector(out, std::vector<int>(dfs_queue.begin(), dfs_queue.end()));
+        write_vector(out, queue_count);
+    }
+}
+
+/**
+ * @brief Conflict::load_state
+ * Restore the state of a worker written by save_state. The moves of an attempt
+ * in progress are made again from the solution before the attempt, so that the
+ * journal can undo them if the attempt fails
+ * @param state
+ */
+void Conflict::load_state(const std::string &state)
+{
+    const int m = segments.size();
+    auto fail = [this]() {
+        std::cerr << "Error reading the state of worker " << worker << " in " << param.resume << std::endl;
+        exit(EXIT_FAILURE);
+    };
+    std::istringstream in(state);
+    worker = read_value<int32_t>(in);
+    power_index = read_value<int32_t>(in);
+    last_progress = read_value<double>(in);
+    param.power = read_value<double>(in);
+    param.noise_var = read_value<double>(in);
+    param.loop_index = read_value<int64_t>(in);
+    const uint64_t nb_colors = read_value<uint64_t>(in);
+    if (!in || worker < 0 || worker >= (int) board->snapshots.size() || power_index < -1
+            || power_index >= (int) param.power_loop.size() || param.loop_index < 0 || nb_colors == 0 || nb_colors > (uint64_t) m)
+        fail();
+
+    // Each segment is in at most one color, or is an easy segment
+    std::vector<char> seen(m, false);
+    auto first_time = [&seen](const std::vector<int> &segs) {
+        for (int si : segs)
+            if (seen[si]++)
+                return false;
+        return true;
+    };
+    classes.assign(nb_colors, std::vector<int>());
+    for (std::vector<int> &members : classes)
+    {
+        members = read_vector<int>(in, m);
+        if (!in || !in_range(members, 0, m) || !first_time(members))
+            fail();
+    }
+    const std::vector<long> easy = read_vector<long>(in, m);
+    if (!in || !in_range<long>(easy, 0, m) || !first_time(std::vector<int>(easy.begin(), easy.end())))
+        fail();
+    easy_segs.assign(easy.begin(), easy.end());
+    noise = read_value<Noise>(in);
+
+    const int attempt = read_value<int32_t>(in);
+    std::vector<int> current;
+    queue_count.assign(m, 0);
+    if (!in || attempt < -1 || attempt >= (int) nb_colors)
+        fail();
+    if (attempt >= 0)
+    {
+        current = read_vector<int>(in, m);
+        const std::vector<int> waiting = read_vector<int>(in, m), dfs_waiting = read_vector<int>(in, m);
+        queue_count = read_vector<int>(in, m);
+        if (!in || current.size() != (size_t) m || !in_range(current, -1, (int) nb_colors - 1)
+                || !in_range(waiting, 0, m) || !in_range(dfs_waiting, 0, m)
+                || queue_count.size() != (size_t) m || !in_range(queue_count, 0, std::numeric_limits<int>::max()))
+            fail();
+        queue.assign(waiting.begin(), waiting.end());
+        dfs_queue.assign(dfs_waiting.begin(), dfs_waiting.end());
+    }
+    build_colorv();
+    set_power(param.power);
 
+    journal.clear();
+    if (attempt >= 0)
+    {
+        drop_color(attempt);
+        for (unsigned si = 0; si < segments.size(); si++)
+            if (colorv[si] >= 0 && colorv[si] != current[si])
+                remove_logged(si, colorv[si]);
+        for (unsigned si = 0; si < segments.size(); si++)
+            if (current[si] >= 0 && colorv[si] != current[si])
+                add_logged(si, current[si]);
     }
-    return (min_conflict < param.max_queue * segments.size());
+    attempt_color = attempt;
+    last_snapshot = elapsed_sec();
+    resumed = true;
+}
+
+/**
+ * @brief Conflict::checkpoint
+ * Every `checkpoint` seconds, save the state of the worker on the board, and write
+ * the checkpoint file. This is called between two attempts to remove a color, and
+ * at each step of an attempt, so that a long attempt is saved too
+ */
+void Conflict::checkpoint()
+{
+    if (param.checkpoint <= 0 || elapsed_sec() - last_snapshot < param.checkpoint)
+        return;
+    last_snapshot = elapsed_sec();
+    std::ostringstream state;
+    save_state(state);
+
+    std::lock_guard<std::mutex> lock(board->mutex);
+    board->snapshots.at(worker) = state.str();
+    write_checkpoint();
 }
 
+/**
+ * @brief Conflict::write_checkpoint
+ * Write the checkpoint file, if all the workers saved their state and the file
+ * was not written during the last `checkpoint` seconds. Any worker may write it,
+ * with the last states of the other workers. The file is written under a
+ * temporary name and then renamed, so that a preempted run never leaves a partial
+ * file. The board must be locked
+ */
+void Conflict::write_checkpoint() const
+{
+    for (const std::string &snapshot : board->snapshots)
+        if (snapshot.empty())
+            return;
+    if (board->last_checkpoint > 0 && elapsed_sec() - board->last_checkpoint < param.checkpoint)
+        return;
+    board->last_checkpoint = elapsed_sec();
+
+    const std::string filename = instance_id + ".conflict.checkpoint";
+    const std::string tmp = filename + ".tmp" + std::to_string(getpid());
+    std::ofstream file(tmp, std::ofstream::out | std::ofstream::binary);
+    file.write(checkpoint_magic, sizeof(checkpoint_magic));
+    write_value<uint32_t>(file, checkpoint_version);
+    write_value<uint64_t>(file, Crossings::hash(segments));
+    write_value<double>(file, elapsed_sec());
+    write_value<int32_t>(file, board->best);
+    write_vector(file, board->colorv);
+    std::vector<double> times;
+    std::vector<int> sizes;
+    for (const auto &pr : board->data_points)
+    {
+        times.push_back(pr.first);
+        sizes.push_back(pr.second);
+    }
+    write_vector(file, times);
+    write_vector(file, sizes);
+    write_vector(file, board->improvements);
+    write_vector(file, board->last_improvement);
+    write_value<uint64_t>(file, board->snapshots.size());
+    for (const std::string &snapshot : board->snapshots)
+        write_vector(file, std::vector<char>(snapshot.begin(), snapshot.end()));
+    file.close();
+
+    if (!file || std::rename(tmp.c_str(), filename.c_str()) != 0)
+    {
+        std::cerr << "Error writing checkpoint file " << filename << std::endl;
+        std::remove(tmp.c_str());
+    }
+    else
+        std::clog << "Checkpoint saved to " << filename << std::endl;
+}
 
-void Conflict::copy_sol(std::vector<std::list<int>> &s1, std::vector<std::list<int>> &s2)
+/**
+ * @brief Conflict::read_checkpoint
+ * Restore the board and the running time from a checkpoint file
+ * @param filename
+ * @return The states of the workers
+ */
+std::vector<std::string> Conflict::read_checkpoint(const std::string &filename)
 {
-    s2.clear();
-    for (const auto &cur_class : s1)
-        s2.push_back(cur_class);
+    std::ifstream file(filename, std::ifstream::in | std::ifstream::binary);
+    char magic[sizeof(checkpoint_magic)] = {};
+    file.read(magic, sizeof(magic));
+    if (!file || std::memcmp(magic, checkpoint_magic, sizeof(magic)) != 0 || read_value<uint32_t>(file) != checkpoint_version)
+    {
+        std::cerr << "Error reading checkpoint file " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (read_value<uint64_t>(file) != Crossings::hash(segments))
+    {
+        std::cerr << "The checkpoint file " << filename << " was written for another instance" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    const int m = segments.size();
+    auto fail = [&filename]() {
+        std::cerr << "Error reading checkpoint file " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    };
+    resumed_sec = read_value<double>(file);
+    board->best = read_value<int32_t>(file);
+    if (!file || board->best <= 0 || board->best > m)
+        fail();
+    board->colorv = read_vector<int>(file, m);
+    if (!file || board->colorv.size() != (size_t) m || !in_range(board->colorv, 0, board->best))
+        fail();
+    const std::vector<double> times = read_vector<double>(file, m); // the number of colors decreases at each data point
+    const std::vector<int> sizes = read_vector<int>(file, m);
+    board->data_points.clear();
+    for (size_t k = 0; k < times.size() && k < sizes.size(); k++)
+        board->data_points.push_back(std::make_pair(times[k], sizes[k]));
+    board->improvements = read_vector<int>(file, param.power_loop.size());
+    board->last_improvement = read_vector<double>(file, param.power_loop.size());
+    const uint64_t nb_states = read_value<uint64_t>(file);
+    if (!file || board->improvements.size() != param.power_loop.size() || board->last_improvement.size() != param.power_loop.size()
+            || nb_states == 0 || nb_states > remaining(file) / sizeof(uint64_t))
+        fail();
+    std::vector<std::string> states(nb_states);
+    for (std::string &state : states)
+    {
+        const std::vector<char> bytes = read_vector<char>(file, remaining(file));
+        if (!file)
+            fail();
+        state.assign(bytes.begin(), bytes.end());
+    }
+    return states;
 }
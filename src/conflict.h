@@ -1,30 +1,65 @@
 #ifndef CONFLICT_H
 #define CONFLICT_H
 
-#include <random>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "solution.hpp"
+#include "crossings.hpp"
+#include "colorcounts.hpp"
+#include "noise.hpp"
 
 /**
  * @brief The Conflict class
  * Implementation of the conflict optimizer.
  * This also includes the DFS heuristic for reducing the queue of conflicts.
+ * Several workers can run in parallel, sharing the crossings and the best solution.
  */
 class Conflict : public Solution
 {
 
     /**
    * @brief The stack_event_t struct
-   * Element in the DFS
+   * Element of the journal of the moves: a segment added to a color, a segment
+   * removed from a color, or a color dropped (the last color taking its index)
    */
     struct stack_event_t {
-        bool was_it_removed;
-        bool was_it_added;
-        int was_removed_from;
-        int was_added_to;
+        enum kind_t { added, removed, dropped } kind;
+        int color;
         int edge;
     };
 
+    /**
+     * @brief The dfs_level_t struct
+     * Candidate colors at one depth of the DFS, with the segments of each color
+     * that would have to move
+     */
+    struct dfs_level_t {
+        std::vector<int> colors;
+        std::vector<int> first; // the segments of colors[i] are segs[first[i]..first[i+1])
+        std::vector<int> segs;
+    };
+
+    static constexpr char checkpoint_magic[8] = "CGSHOPK"; // first bytes of a checkpoint file
+    static constexpr uint32_t checkpoint_version = 2; // version of the format of the checkpoint files
+
+    /**
+     * @brief The Board struct
+     * Best solution found by the workers, shared by all of them
+     */
+    struct Board {
+        std::mutex mutex;
+        int best = std::numeric_limits<int>::max(); // number of colors of the best solution
+        std::vector<int> colorv; // best solution
+        std::string graph_file; // file of the data points
+        std::list<std::pair<double,int>> data_points; // (time, number of colors) of each improvement, for plotting statistics
+        std::vector<int> improvements; // improvements[p] = number of improvements found with the p-th power of the power loop
+        std::vector<double> last_improvement; // last_improvement[p] = time of the last improvement found with the p-th power
+        std::vector<std::string> snapshots; // snapshots[w] = last saved state of the w-th worker
+        double last_checkpoint = 0; // time of the last writing of the checkpoint file
+    };
+
 public:
     Conflict(Parameters param);
 
@@ -33,43 +68,84 @@ public:
 
 private:
     void init_solution();
+    void search();
+    bool portfolio() const;
+    void configure_worker(int w);
+    void reassign();
+    void save_state(std::ostream &out) const;
+    void load_state(const std::string &state);
+    void checkpoint();
+    void write_checkpoint() const;
+    std::vector<std::string> read_checkpoint(const std::string &filename);
+    void publish();
+    bool adopt_best();
     void generate_intersection_map();
     bool crosses(int si, int sj) const;
     bool edge_can_be_added_to_graph(int si, int c) const;
+    void add_to_class(int si, int c);
+    void remove_from_class(int si, int c);
+    double segment_weight(int si) const;
+    void set_power(double power);
+    void extend_weight_table(int q);
+    bool is_blocked(int si) const;
+    void increment_queue_count(int si);
+    void build_color_counts();
     void remove_easy_segs(int bound);
     void add_easy_segs();
     bool shuffle(int n = 11);
     void shuffle_once();
     bool optimize();
+    bool improve();
     void reset_queue_count();
     void move_segments(unsigned c);
     void build_colorv();
+    void build_peel_order();
     int conflict_dfs_optim_solution(bool one_shot);
     int add_data_point_to_graph_file();
-    bool best_color(int seg, int &best_c, std::list<int> &conflicting_segs);
-    void copy_sol(std::vector<std::list<int>> &s1, std::vector<std::list<int>> &s2);
+    std::string graph_file_name() const;
+    bool best_color(int seg, int &best_c, std::vector<int> &conflicting_segs);
+    void add_logged(int si, int c);
+    void remove_logged(int si, int c);
+    void drop_color(int c);
+    void restore_color(int c);
 
-    int dfsOptimize(std::list<int> &todo, std::list<int> &forbidden, int breadth, int depth, std::list<stack_event_t> &changes);
-    void get_colors_with_small_conflict_number(int e, int breadth, std::list<int> &forbidden, std::list<std::pair<int, std::list<int>>> &conflict_colors);
-    int get_intersectors(int c, int e, std::list<int> &intersectors, int max_intersections, std::list<int> &forbidden);
-    bool in_list(int i, const std::list<int> &l) const;
-    void remove_edges_from_color(int color, const std::list<int> &conflicts);
-    int add_edges_to_color(int color, const std::list<int> &conflicts);
-    int undo_changes(std::list<stack_event_t> &changes);
-    int undo_change(stack_event_t &evt);
-    int undo_added(stack_event_t &evt);
-    int undo_removed(stack_event_t &evt);
+    int dfs(int seg, int depth);
+    int dfsOptimize(const int *todo, int nb_todo, int breadth, int depth);
+    void get_colors_with_small_conflict_number(int e, int breadth, dfs_level_t &level);
+    void rollback(size_t size);
+    void undo_change(const stack_event_t &evt);
 
 
 private:
-    std::vector<std::list<int>> classes; // classes[c] = list of (indices of) segments labeled as c
+    std::vector<std::vector<int>> classes; // classes[c] = (indices of) segments labeled as c, in no particular order
+    std::vector<int> class_pos; // class_pos[i] = position of the i-th segment in its color
     std::list<long> easy_segs;
-    std::vector<std::vector<unsigned int>> crossings; // data structure encoding the crossing between segments
+    std::vector<int> peel_order; // segments in the order of their removal by the peeling of the minimum degrees
+    std::vector<int> peel_bound; // peel_bound[i] = maximum degree of the i+1 first segments of peel_order, when they are removed
+    std::shared_ptr<const Crossings> crossings; // data structure encoding the crossing between segments, shared by the workers
     std::vector<int> queue_count; // queue_count[i] = number of times the i-th segment has been enqueued
-    std::list<std::pair<double,int>> data_points; // data for plotting statistics
+    ColorCounts color_counts; // number and weight of the segments of each color crossing each segment
+    std::vector<double> color_weight; // buffer for the score of each color in best_color
+    std::vector<stack_event_t> journal; // moves of the current attempt to remove a color, undone up to a savepoint when it fails
+    int attempt_color = -1; // index of the color dropped by the attempt in progress, -1 between two attempts
+    std::list<int> queue; // segments of the attempt in progress waiting for a color
+    std::list<int> dfs_queue; // segments of the attempt in progress removed from their color, to be placed by the DFS first
+    std::vector<dfs_level_t> dfs_levels; // dfs_levels[d] = candidate colors at the depth d of the DFS
+    std::vector<unsigned> forbidden_stamp; // forbidden_stamp[i] == dfs_epoch if the i-th segment cannot be moved by the DFS
+    unsigned dfs_epoch = 0; // number of DFS started
+    std::vector<int> color_slot; // buffer for the index of each color in the candidates of get_colors_with_small_conflict_number
+    std::vector<int> slot_fill; // buffer for the number of segments found for each candidate in get_colors_with_small_conflict_number
+    std::vector<char> slot_dropped; // buffer for the candidates crossing a forbidden segment in get_colors_with_small_conflict_number
+
+    int worker = 0; // index of the worker
+    int power_index = -1; // index of the power of the worker in the power loop, in the portfolio mode
+    double last_progress = 0; // time of the last improvement or power change of the worker
+    double last_snapshot = 0; // time of the last saved state of the worker
+    bool resumed = false; // true if the worker has been restored from a checkpoint and did not restart yet
+    std::shared_ptr<Board> board; // best solution, shared by the workers
 
-    std::default_random_engine generator;
-    std::normal_distribution<double> distribution;
+    std::vector<double> weight_table; // weight_table[q] = weight of a segment enqueued q times, for the current power
+    Noise noise; // noise of the scores of the colors
 };
 
 #endif // CONFLICT_H
@@ -0,0 +1,688 @@
+#ifndef CROSSINGS
+#define CROSSINGS
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "primitives.hpp"
+#include "batch.hpp"
+
+/**
+ * @brief The Crossings class
+ * Precomputed crossing graph of a list of segments.
+ * Segment::cross only returns true for segments whose bounding boxes overlap, so
+ * the bounding boxes are first bucketed in a grid, and the exact predicate is only
+ * run on pairs of segments with overlapping bounding boxes.
+ * Each row of the crossing matrix is stored either as the sorted list of the
+ * segments crossing it, or as a bitset when that is smaller (a bit per segment
+ * against 32 bits per crossing). When the full bitset is small, it is kept for all
+ * the rows, and the lists are only used to enumerate the crossings quickly.
+ * The crossings can be saved to a cache file, which is memory-mapped by later runs on
+ * the same segments instead of computing the crossings again
+ */
+class Crossings
+{
+    static constexpr size_t raw_limit = size_t(64) << 20; // size up to which the full bitset is kept
+
+    int m = 0; // number of segments
+    size_t words = 0; // number of 64-bit words per row
+    bool raw = true; // true if all the rows are stored as bitsets
+    std::vector<int> deg; // deg[si] = number of segments crossing si
+    std::vector<const uint64_t *> row_bits; // row_bits[si] = bitset of the segments crossing si, or nullptr
+    std::vector<uint64_t> owned; // storage of the bitsets, when they are not mapped from a cache file
+    std::vector<size_t> start; // the list of the segments crossing si is adjacency[start[si]..start[si+1]), empty for dense rows
+    std::vector<int> adjacency;
+    void *mapping = nullptr; // cache file mapped in memory, if any
+    size_t mapping_size = 0;
+
+    /**
+     * @brief The Header struct
+     * Header of a cache file. It is followed, from offset header_size, by the degrees
+     * of the segments (32-bit), the lists of the rows that are not dense (32-bit), and
+     * the bitsets of the dense rows, aligned on 64 bits
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t word_bits;
+        uint64_t hash;
+        uint64_t m;
+        uint64_t words;
+        uint64_t nb_dense; // number of rows stored as bitsets
+        uint64_t nb_adjacency; // total length of the lists
+    };
+    static constexpr char magic[8] = "CGSHOPX";
+    static constexpr uint32_t version = 2;
+    static constexpr size_t header_size = 64;
+
+    /**
+     * @brief bitsets_offset
+     * @return The offset of the dense rows in a cache file
+     */
+    static size_t bitsets_offset(size_t m, size_t nb_adjacency)
+    {
+        const size_t end = header_size + (m + nb_adjacency) * sizeof(int32_t);
+        return (end + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+    }
+
+    /**
+     * @brief The Grid struct
+     * Hierarchical grid over the bounding boxes of the segments. The cells of level l
+     * have side side0 * 2^l. Each segment is stored once, in the cell containing the
+     * lower corner of its bounding box, at the finest level whose cells are at least
+     * as large as its bounding box. Hence a bounding box only overlaps the 3x3 cells
+     * around it at its own level and at any coarser level
+     */
+    struct Grid {
+        double x0, y0, side0;
+        std::vector<int> level; // level[i] = level of the i-th segment
+        std::vector<int> nx, ny; // number of columns and rows of each level
+        std::vector<std::vector<int>> cell_start, cell_segs; // segments of cell c of level l are cell_segs[l][cell_start[l][c]..cell_start[l][c+1])
+
+        static i64 minx(const Segment &s) { return s.get_p().x; } // p.x <= q.x
+        static i64 maxx(const Segment &s) { return s.get_q().x; }
+        static i64 miny(const Segment &s) { return std::min(s.get_p().y, s.get_q().y); }
+        static i64 maxy(const Segment &s) { return std::max(s.get_p().y, s.get_q().y); }
+
+        int cellx(int l, i64 x) const {
+            return std::clamp((int) std::floor((x - x0) / std::ldexp(side0, l)), 0, nx[l] - 1);
+        }
+
+        int celly(int l, i64 y) const {
+            return std::clamp((int) std::floor((y - y0) / std::ldexp(side0, l)), 0, ny[l] - 1);
+        }
+
+        Grid(const std::vector<Segment> &segments)
+        {
+            const int m = segments.size();
+            i64 x1 = minx(segments[0]), y1 = miny(segments[0]);
+            x0 = x1;
+            y0 = y1;
+            for (const Segment &s : segments)
+            {
+                x0 = std::min<double>(x0, minx(s));
+                y0 = std::min<double>(y0, miny(s));
+                x1 = std::max(x1, maxx(s));
+                y1 = std::max(y1, maxy(s));
+            }
+
+            // About one cell per segment at the finest level
+            const double w = std::max<double>(x1 - x0, 1);
+            const double h = std::max<double>(y1 - y0, 1);
+            side0 = std::max(std::sqrt(w * h / m), 1.0);
+            int levels = 1;
+            while (std::ldexp(side0, levels - 1) < std::max(w, h))
+                levels++;
+            for (int l = 0; l < levels; l++)
+            {
+                nx.push_back((int) (w / std::ldexp(side0, l)) + 1);
+                ny.push_back((int) (h / std::ldexp(side0, l)) + 1);
+            }
+
+            level.resize(m);
+            for (int si = 0; si < m; si++)
+            {
+                const Segment &s = segments[si];
+                const i64 size = std::max(maxx(s) - minx(s), maxy(s) - miny(s));
+                int l = 0;
+                while (l < levels - 1 && std::ldexp(side0, l) < size)
+                    l++;
+                level[si] = l;
+            }
+
+            // Counting sort of the segments by cell, at each level
+            cell_start.resize(levels);
+            cell_segs.resize(levels);
+            std::vector<int> cell(m);
+            for (int si = 0; si < m; si++)
+            {
+                const int l = level[si];
+                cell[si] = cellx(l, minx(segments[si])) * ny[l] + celly(l, miny(segments[si]));
+            }
+            for (int l = 0; l < levels; l++)
+                cell_start[l].assign((size_t) nx[l] * ny[l] + 1, 0);
+            for (int si = 0; si < m; si++)
+                cell_start[level[si]][cell[si] + 1]++;
+            for (int l = 0; l < levels; l++)
+            {
+                for (size_t c = 1; c < cell_start[l].size(); c++)
+                    cell_start[l][c] += cell_start[l][c - 1];
+                cell_segs[l].resize(cell_start[l].back());
+            }
+            std::vector<std::vector<int>> fill(levels);
+            for (int l = 0; l < levels; l++)
+                fill[l].assign(cell_start[l].begin(), cell_start[l].end() - 1);
+            for (int si = 0; si < m; si++)
+                cell_segs[level[si]][fill[level[si]][cell[si]]++] = si;
+        }
+
+        /**
+         * @brief candidates
+         * Enumerate the segments whose bounding box overlaps the one of the i-th segment.
+         * Each unordered pair is enumerated once, from the segment of finer level (or
+         * from the segment of smaller index if both have the same level)
+         * @param segments
+         * @param i Index of a segment
+         * @param out Function called with the index of each candidate
+         */
+        template <typename F>
+        void candidates(const std::vector<Segment> &segments, int i, F &&out) const
+        {
+            const Segment &s = segments[i];
+            for (int l = level[i]; l < (int) cell_start.size(); l++)
+            {
+                const int cx0 = std::max(cellx(l, minx(s)) - 1, 0), cx1 = cellx(l, maxx(s));
+                const int cy0 = std::max(celly(l, miny(s)) - 1, 0), cy1 = celly(l, maxy(s));
+                for (int cx = cx0; cx <= cx1; cx++)
+                    for (int cy = cy0; cy <= cy1; cy++)
+                    {
+                        const int c = cx * ny[l] + cy;
+                        for (int k = cell_start[l][c]; k < cell_start[l][c + 1]; k++)
+                        {
+                            const int j = cell_segs[l][k];
+                            if (l == level[i] && j <= i)
+                                continue;
+                            const Segment &t = segments[j];
+                            if (minx(t) <= maxx(s) && minx(s) <= maxx(t) && miny(t) <= maxy(s) && miny(s) <= maxy(t))
+                                out(j);
+                        }
+                    }
+            }
+        }
+    };
+
+    /**
+     * @brief dense
+     * @param d Number of crossings of a row
+     * @return True if the row is smaller as a bitset than as a list
+     */
+    bool dense(size_t d) const
+    {
+        return dense(d, words);
+    }
+
+    static bool dense(size_t d, size_t words)
+    {
+        return d * sizeof(int) > words * sizeof(uint64_t);
+    }
+
+    /**
+     * @brief choose_representation
+     * Decide, from the degrees, whether we keep the full bitset, and allocate the lists
+     */
+    void choose_representation()
+    {
+        raw = m * words * sizeof(uint64_t) <= raw_limit;
+        start.assign(m + 1, 0);
+        for (int si = 0; si < m; si++)
+            start[si + 1] = start[si] + (dense(deg[si]) ? 0 : deg[si]);
+        adjacency.assign(start[m], 0);
+        row_bits.assign(m, nullptr);
+    }
+
+    void unmap()
+    {
+        if (mapping)
+            munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+    }
+
+    void clear()
+    {
+        unmap();
+        deg.clear();
+        row_bits.clear();
+        owned.clear();
+        owned.shrink_to_fit();
+        start.clear();
+        adjacency.clear();
+        adjacency.shrink_to_fit();
+    }
+
+    /**
+     * @brief report
+     * Print the representation and the memory used
+     */
+    void report() const
+    {
+        size_t bytes = deg.size() * sizeof(int) + row_bits.size() * sizeof(uint64_t *)
+                + owned.size() * sizeof(uint64_t) + start.size() * sizeof(size_t) + adjacency.size() * sizeof(int);
+        size_t bitset_rows = 0;
+        for (const uint64_t *row : row_bits)
+            bitset_rows += row != nullptr;
+        std::clog << "Crossings: " << (raw ? "full bitset" : "hybrid") << " representation, "
+                  << bitset_rows << " bitset rows, " << bytes / 1048576.0 << " MiB"
+                  << (mapping ? " + " + std::to_string(mapping_size / 1048576.0) + " MiB mapped from the cache file" : "")
+                  << " (full bitset: " << m * words * sizeof(uint64_t) / 1048576.0 << " MiB)" << std::endl;
+    }
+
+public:
+    /**
+     * @brief build
+     * Compute the crossings between all the segments.
+     * The rows are handed out in small chunks to the threads, so that the threads
+     * that get the cheap rows take more of them. Each thread only records the
+     * crossing pairs it finds, and the rows are filled once all the threads are done
+     * @param segments
+     * @param batch Structure-of-arrays copy of the segments
+     * @param threads Number of threads
+     */
+    void build(const std::vector<Segment> &segments, const SegmentBatch &batch, int threads = 1)
+    {
+        clear();
+        m = segments.size();
+        words = (m + 63) / 64;
+        if (m == 0)
+            return;
+
+        const Grid grid(segments);
+        const int chunk = 64;
+        std::atomic<int> next_row(0);
+        std::atomic<long> tested(0);
+        std::vector<std::vector<int>> found(m); // found[i] = crossing segments found from the i-th segment
+
+        auto worker = [&]() {
+            long count = 0;
+            int block[SegmentBatch::block]; // candidates waiting to be tested against the i-th segment
+            int n = 0;
+            auto flush = [&](int i) {
+                for (unsigned mask = batch.cross(i, block, n); mask; mask &= mask - 1)
+                    found[i].push_back(block[__builtin_ctz(mask)]);
+                count += n;
+                n = 0;
+            };
+            for (int i0 = next_row.fetch_add(chunk); i0 < m; i0 = next_row.fetch_add(chunk))
+                for (int i = i0; i < std::min(i0 + chunk, m); i++)
+                {
+                    grid.candidates(segments, i, [&](int j) {
+                        block[n++] = j;
+                        if (n == SegmentBatch::block)
+                            flush(i);
+                    });
+                    if (n > 0)
+                        flush(i);
+                }
+            tested += count;
+        };
+
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++)
+            pool.push_back(std::thread(worker));
+        worker();
+        for (std::thread &th : pool)
+            th.join();
+
+        long pairs = 0;
+        deg.assign(m, 0);
+        for (int i = 0; i < m; i++)
+            for (int j : found[i])
+            {
+                deg[i]++;
+                deg[j]++;
+                pairs++;
+            }
+
+        choose_representation();
+        size_t nb_bitsets = 0;
+        for (int si = 0; si < m; si++)
+            nb_bitsets += raw || dense(deg[si]);
+        owned.assign(nb_bitsets * words, 0);
+        std::vector<uint64_t *> rows(m, nullptr);
+        for (int si = 0, r = 0; si < m; si++)
+            if (raw || dense(deg[si]))
+                row_bits[si] = rows[si] = owned.data() + words * r++;
+
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        auto add = [&](int si, int sj) {
+            if (rows[si])
+                rows[si][sj / 64] |= uint64_t(1) << (sj % 64);
+            if (!dense(deg[si]))
+                adjacency[fill[si]++] = sj;
+        };
+        for (int i = 0; i < m; i++)
+        {
+            for (int j : found[i])
+            {
+                add(i, j);
+                add(j, i);
+            }
+            std::vector<int>().swap(found[i]);
+        }
+        for (int si = 0; si < m; si++)
+            std::sort(adjacency.begin() + start[si], adjacency.begin() + start[si + 1]);
+
+        std::clog << "Crossings: " << pairs << " crossing pairs among " << tested << " candidate pairs ("
+                  << grid.cell_start.size() << " grid levels, " << std::max(threads, 1) << " threads)" << std::endl;
+        report();
+    }
+
+    /**
+     * @brief build
+     * Load the crossings from a cache file, or compute them and write the cache file
+     * if it is missing or does not match the segments
+     * @param segments
+     * @param batch Structure-of-arrays copy of the segments
+     * @param threads Number of threads
+     * @param cache Name of the cache file. No cache is used if it is empty
+     */
+    void build(const std::vector<Segment> &segments, const SegmentBatch &batch, int threads, const std::string &cache)
+    {
+        if (cache.empty())
+            build(segments, batch, threads);
+        else if (load(cache, hash(segments), segments.size()))
+            std::clog << "Crossings loaded from " << cache << std::endl;
+        else
+        {
+            build(segments, batch, threads);
+            save(cache, hash(segments));
+        }
+    }
+
+    /**
+     * @brief hash
+     * @param segments
+     * @return A hash of the list of segments (64-bit FNV-1a of the coordinates)
+     */
+    static uint64_t hash(const std::vector<Segment> &segments)
+    {
+        uint64_t h = 14695981039346656037ull;
+        auto add = [&h](i64 v) {
+            for (int b = 0; b < 8; b++)
+            {
+                h ^= (v >> (8 * b)) & 0xff;
+                h *= 1099511628211ull;
+            }
+        };
+        add(segments.size());
+        for (const Segment &s : segments)
+        {
+            add(s.get_p().x);
+            add(s.get_p().y);
+            add(s.get_q().x);
+            add(s.get_q().y);
+        }
+        return h;
+    }
+
+    /**
+     * @brief read_at
+     * Read size bytes of the file at the given offset
+     * @return False if the file is too short
+     */
+    static bool read_at(int fd, void *buffer, size_t size, size_t offset)
+    {
+        for (char *p = (char *) buffer; size > 0; )
+        {
+            const ssize_t n = pread(fd, p, size, offset);
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= n;
+            offset += n;
+        }
+        return true;
+    }
+
+    /**
+     * @brief load
+     * Read the degrees and the lists of a cache file, and map its dense rows in
+     * memory. Only the part of the file holding the dense rows is mapped, and
+     * nothing is mapped if there is no dense row. Every field of the header is
+     * checked against the size of the file
+     * @param filename
+     * @param key Hash of the segments
+     * @param nb_segments Number of segments
+     * @return False if the file is missing, or was written for other segments or by
+     * another version of this code
+     */
+    bool load(const std::string &filename, uint64_t key, int nb_segments)
+    {
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        Header h;
+        if (fstat(fd, &st) != 0 || !read_at(fd, &h, sizeof(h), 0))
+        {
+            std::clog << "Ignoring cache file " << filename << " (wrong size)" << std::endl;
+            close(fd);
+            return false;
+        }
+
+        const size_t size = st.st_size;
+        const uint64_t n = nb_segments;
+        const uint64_t n_words = (n + 63) / 64;
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version || h.word_bits != 64
+                || h.hash != key || h.m != n || h.words != n_words || h.nb_dense > n
+                || h.nb_adjacency > n * n || bitsets_offset(n, h.nb_adjacency) + h.nb_dense * n_words * sizeof(uint64_t) != size)
+        {
+            std::clog << "Ignoring cache file " << filename << " (stale)" << std::endl;
+            close(fd);
+            return false;
+        }
+
+        // The degrees must agree with the number of dense rows and the length of the lists
+        std::vector<int32_t> degrees(n + h.nb_adjacency);
+        bool valid = read_at(fd, degrees.data(), degrees.size() * sizeof(int32_t), header_size);
+        uint64_t nb_dense = 0, nb_adjacency = 0;
+        for (int si = 0; si < nb_segments && valid; si++)
+        {
+            valid = degrees[si] >= 0 && degrees[si] < nb_segments;
+            if (dense(degrees[si], n_words))
+                nb_dense++;
+            else
+                nb_adjacency += degrees[si];
+        }
+        for (size_t k = n; k < degrees.size() && valid; k++)
+            valid = degrees[k] >= 0 && degrees[k] < nb_segments;
+        void *map = nullptr;
+        const size_t offset = bitsets_offset(n, h.nb_adjacency);
+        const size_t page = sysconf(_SC_PAGESIZE);
+        if (valid && nb_dense == h.nb_dense && nb_adjacency == h.nb_adjacency && nb_dense > 0)
+        {
+            map = mmap(nullptr, size - offset / page * page, PROT_READ, MAP_SHARED, fd, offset / page * page);
+            valid = map != MAP_FAILED;
+        }
+        close(fd);
+        if (!valid || nb_dense != h.nb_dense || nb_adjacency != h.nb_adjacency)
+        {
+            std::clog << "Ignoring cache file " << filename << " (corrupted)" << std::endl;
+            return false;
+        }
+
+        clear();
+        if (map)
+        {
+            mapping = map;
+            mapping_size = size - offset / page * page;
+        }
+        m = nb_segments;
+        words = n_words;
+        deg.assign(degrees.begin(), degrees.begin() + m);
+        choose_representation();
+        adjacency.assign(degrees.begin() + m, degrees.end());
+
+        // With the full bitset, the rows stored as lists also get a bitset
+        if (raw)
+            owned.assign((m - nb_dense) * words, 0);
+        for (int si = 0, r = 0; si < m; si++)
+            if (dense(deg[si]))
+                row_bits[si] = (const uint64_t *) ((const char *) map + offset % page) + words * r++;
+        for (int si = 0, r = 0; raw && si < m; si++)
+            if (!dense(deg[si]))
+            {
+                uint64_t *row = owned.data() + words * r++;
+                for (int sj : neighbors(si))
+                    row[sj / 64] |= uint64_t(1) << (sj % 64);
+                row_bits[si] = row;
+            }
+        report();
+        return true;
+    }
+
+    /**
+     * @brief save
+     * Write the crossings to a cache file, in the same representation as in memory:
+     * the degrees, then the lists, then the bitsets of the dense rows. The file is
+     * written under a temporary name and then renamed, so that a concurrent run never
+     * maps a partial file
+     * @param filename
+     * @param key Hash of the segments
+     */
+    void save(const std::string &filename, uint64_t key) const
+    {
+        Header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.word_bits = 64;
+        h.hash = key;
+        h.m = m;
+        h.words = words;
+        for (int si = 0; si < m; si++)
+            h.nb_dense += dense(deg[si]);
+        h.nb_adjacency = adjacency.size();
+        char header[header_size] = {};
+        std::memcpy(header, &h, sizeof(h));
+
+        const std::string tmp = filename + ".tmp" + std::to_string(getpid());
+        std::ofstream file(tmp, std::ofstream::out | std::ofstream::binary);
+        file.write(header, header_size);
+        static_assert(sizeof(int) == sizeof(int32_t), "the degrees and the lists are written as 32-bit integers");
+        file.write((const char *) deg.data(), (std::streamsize) (deg.size() * sizeof(int)));
+        file.write((const char *) adjacency.data(), (std::streamsize) (adjacency.size() * sizeof(int)));
+        const char padding[sizeof(uint64_t)] = {};
+        file.write(padding, (std::streamsize) (bitsets_offset(m, adjacency.size()) - header_size - (m + adjacency.size()) * sizeof(int)));
+        for (int si = 0; si < m; si++)
+            if (dense(deg[si]))
+                file.write((const char *) row_bits[si], (std::streamsize) (words * sizeof(uint64_t)));
+        file.close();
+        if (!file || std::rename(tmp.c_str(), filename.c_str()) != 0)
+        {
+            std::cerr << "Error writing cache file " << filename << std::endl;
+            std::remove(tmp.c_str());
+        }
+        else
+            std::clog << "Crossings saved to " << filename << std::endl;
+    }
+
+    /**
+     * @brief cross
+     * @param si
+     * @param sj
+     * @return True if the segments with indices si and sj cross
+     */
+    bool cross(int si, int sj) const
+    {
+        if (row_bits[si])
+            return (row_bits[si][sj / 64] >> (sj % 64)) & 1;
+        if (row_bits[sj])
+            return (row_bits[sj][si / 64] >> (si % 64)) & 1;
+        return std::binary_search(adjacency.begin() + start[si], adjacency.begin() + start[si + 1], sj);
+    }
+
+    /**
+     * @brief The Neighbors struct
+     * Range of the indices of the segments crossing a segment, read either from its
+     * list or from its bitset
+     */
+    struct Neighbors {
+        struct Iterator {
+            const int *p; // position in the list, or nullptr for a bitset
+            const uint64_t *row;
+            size_t w, words;
+            uint64_t x; // bits of row[w] not visited yet
+
+            void skip() { while (x == 0 && ++w < words) x = row[w]; }
+            int operator*() const { return p ? *p : w * 64 + __builtin_ctzll(x); }
+            Iterator &operator++() { if (p) ++p; else { x &= x - 1; skip(); } return *this; }
+            bool operator!=(const Iterator &it) const { return p != it.p || w != it.w; }
+        };
+
+        Iterator first, last;
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+    };
+
+    /**
+     * @brief neighbors
+     * @param si
+     * @return The indices of the segments crossing the si-th segment, in increasing order
+     */
+    Neighbors neighbors(int si) const
+    {
+        if (dense(deg[si]))
+        {
+            Neighbors::Iterator first{nullptr, row_bits[si], 0, words, row_bits[si][0]};
+            first.skip();
+            return Neighbors{first, Neighbors::Iterator{nullptr, row_bits[si], words, words, 0}};
+        }
+        const int *list = adjacency.data();
+        return Neighbors{Neighbors::Iterator{list + start[si], nullptr, 0, 0, 0},
+                         Neighbors::Iterator{list + start[si + 1], nullptr, 0, 0, 0}};
+    }
+
+    /**
+     * @brief degree
+     * @param si
+     * @return The number of segments crossing the si-th segment
+     */
+    int degree(int si) const
+    {
+        return deg[si];
+    }
+
+    /**
+     * @brief row
+     * @param si
+     * @return The bitset of the segments crossing the si-th segment, or nullptr if
+     * this row is only stored as a list
+     */
+    const uint64_t *row(int si) const
+    {
+        return row_bits[si];
+    }
+
+    /**
+     * @brief nb_words
+     * @return The number of 64-bit words of a bitset row
+     */
+    size_t nb_words() const
+    {
+        return words;
+    }
+
+    bool empty() const
+    {
+        return m == 0;
+    }
+
+    size_t size() const
+    {
+        return m;
+    }
+
+    Crossings()
+    {}
+
+    Crossings(const Crossings &) = delete;
+    Crossings &operator=(const Crossings &) = delete;
+
+    ~Crossings()
+    {
+        unmap();
+    }
+};
+
+#endif // CROSSINGS
@@ -7,55 +7,165 @@
 
 /**
  * @brief The DSatHull class
+ * DSatur variant giving each segment the available color whose convex hull grows
+ * the least. The hulls are in clockwise order, and the growth of a hull is computed
+ * from its edges seen by the endpoints of the segment, without building the new hull.
+ * A lower bound on this growth, from the bounding box of the hull, rejects most of
+ * the colors before going through their hull
  */
 class DSatHull : public DSatur {
-    std::vector<std::vector<Point>> colorhulls; // colorhulls[c] = list of points in the convex hull of the segments with color c
+    /**
+     * @brief The Hull struct
+     * Convex hull of the segments of a color, with its area and bounding box
+     */
+    struct Hull {
+        std::vector<Point> points; // vertices in clockwise order
+        i64 area = 0; // twice the area
+        i64 minx = 0, maxx = 0, miny = 0, maxy = 0;
+    };
+
+    std::vector<Hull> colorhulls; // colorhulls[c] = convex hull of the segments with color c
 
     /**
-     * @brief bestAvailable
-     * @param si Index of a segment
-     * @return Best color available
+     * @brief cross
+     * @return Twice the signed area of the triangle abr, positive if r is on the left
+     * of ab, that is outside a clockwise hull with the edge ab
      */
-    int bestAvailable(int si) {
-        std::vector<int> possible;
+    static i64 cross(const Point &a, const Point &b, const Point &r)
+    {
+        return (b.x - a.x) * (r.y - a.y) - (b.y - a.y) * (r.x - a.x);
+    }
 
-        for (unsigned int c = 0; c < colorhulls.size(); c++)
-            if (c >= neighbor_colors[si].size() || !neighbor_colors[si][c])
-                possible.push_back(c);
+    /**
+     * @brief growth_lower_bound
+     * Lower bound on the growth of twice the area of a hull when adding a point, from
+     * its bounding box. If p is at distance d to the right of the box, and between its
+     * bottom and top, the triangle of p and the bottom and top points of the hull is in
+     * the new hull, and its part to the right of the box has at least twice the area
+     * d * d * height / (p.x - minx). The same holds for the other sides
+     */
+    static double growth_lower_bound(const Hull &hull, const Point &p)
+    {
+        const double width = hull.maxx - hull.minx, height = hull.maxy - hull.miny;
+        if (hull.miny <= p.y && p.y <= hull.maxy)
+        {
+            if (p.x > hull.maxx)
+                return double(p.x - hull.maxx) * (p.x - hull.maxx) * height / (p.x - hull.minx);
+            if (p.x < hull.minx)
+                return double(hull.minx - p.x) * (hull.minx - p.x) * height / (hull.maxx - p.x);
+        }
+        if (hull.minx <= p.x && p.x <= hull.maxx)
+        {
+            if (p.y > hull.maxy)
+                return double(p.y - hull.maxy) * (p.y - hull.maxy) * width / (p.y - hull.miny);
+            if (p.y < hull.miny)
+                return double(hull.miny - p.y) * (hull.miny - p.y) * width / (hull.maxy - p.y);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief growth
+     * @return The growth of twice the area of a hull of positive area when adding the
+     * points p and q. Adding p adds the triangles of p and the edges it sees, and
+     * replaces these edges by two edges through p. Adding q then adds the triangles of q
+     * and the edges of this new hull it sees
+     */
+    static i64 growth(const Hull &hull, const Point &p, const Point &q)
+    {
+        const std::vector<Point> &h = hull.points;
+        const size_t n = h.size();
+        i64 diff = 0;
+        bool prev_seen = cross(h[n - 1], h[0], p) > 0; // p sees the edge before the current one
+        bool seen = cross(h[0], h[1 % n], p) > 0; // p sees the current edge
+        for (size_t i = 0; i < n; i++)
+        {
+            const Point &a = h[i], &b = h[(i + 1) % n];
+            const bool next_seen = cross(b, h[(i + 2) % n], p) > 0;
+            if (!seen)
+                diff += std::max<i64>(0, cross(a, b, q));
+            else
+            {
+                diff += cross(a, b, p);
+                if (!prev_seen) // first edge seen by p, replaced by ap
+                    diff += std::max<i64>(0, cross(a, p, q));
+                if (!next_seen) // last edge seen by p, replaced by pb
+                    diff += std::max<i64>(0, cross(p, b, q));
+            }
+            prev_seen = seen;
+            seen = next_seen;
+        }
+        return diff;
+    }
 
-        if (possible.empty())
+    /**
+     * @brief add_to_hull
+     * Add a segment to a hull, and update its area and its bounding box
+     */
+    void add_to_hull(Hull &hull, const Segment &s)
+    {
+        std::vector<Point> &ch = hull.points;
+        if (std::count(ch.begin(), ch.end(), s.get_p()) == 0)
+            ch.push_back(s.get_p());
+        if (std::count(ch.begin(), ch.end(), s.get_q()) == 0)
+            ch.push_back(s.get_q());
+        ch = convex_hull(ch);
+        hull.area = ch.size() > 2 ? polyArea2(ch) : 0;
+        hull.minx = hull.maxx = ch[0].x;
+        hull.miny = hull.maxy = ch[0].y;
+        for (const Point &v : ch)
         {
-            std::vector<Point> vec = {segments[si].get_p(), segments[si].get_q()};
-            colorhulls.push_back(vec);
-            return colorhulls.size() - 1;
+            hull.minx = std::min(hull.minx, v.x);
+            hull.maxx = std::max(hull.maxx, v.x);
+            hull.miny = std::min(hull.miny, v.y);
+            hull.maxy = std::max(hull.maxy, v.y);
         }
+    }
+
+    /**
+     * @brief bestAvailable
+     * @param si Index of a segment
+     * @return Best color available
+     */
+    int bestAvailable(int si) {
+        const Point &p = segments[si].get_p(), &q = segments[si].get_q();
 
         // Find convex hull with min area increase
         int bestc = -1;
         i64 bestdiff = LLONG_MAX;
-        for (int c : possible)
+        for (unsigned int c = 0; c < colorhulls.size(); c++)
         {
-            std::vector<Point> ch = colorhulls[c];
-            i64 a1 = polyArea2(ch);
-            if (std::count(ch.begin(), ch.end(), segments[si].get_p()) == 0)
-                ch.push_back(segments[si].get_p());
-            if (std::count(ch.begin(), ch.end(), segments[si].get_q()) == 0)
-                ch.push_back(segments[si].get_q());
-            ch = convex_hull(ch);
-            i64 a2 = polyArea2(ch);
-            i64 diff = a2 - a1;
+            if (has_neighbor_color(si, c))
+                continue;
+            const Hull &hull = colorhulls[c];
+            // the growth is an integer at least the bound, so that it is at least bestdiff when the bound is more than bestdiff - 1
+            if (hull.area > 0 && bestdiff != LLONG_MAX && std::max(growth_lower_bound(hull, p), growth_lower_bound(hull, q)) > bestdiff - 0.5)
+                continue;
+            i64 diff;
+            if (hull.area > 0)
+                diff = growth(hull, p, q);
+            else // flat hull, where adding p may also lengthen the hull
+            {
+                std::vector<Point> ch = hull.points;
+                if (std::count(ch.begin(), ch.end(), p) == 0)
+                    ch.push_back(p);
+                if (std::count(ch.begin(), ch.end(), q) == 0)
+                    ch.push_back(q);
+                ch = convex_hull(ch);
+                diff = polyArea2(ch) - polyArea2(hull.points);
+            }
             if (diff < bestdiff) {
                 bestc = c;
                 bestdiff = diff;
             }
         }
 
-        // Update convex hull
-        if (std::count(colorhulls[bestc].begin(), colorhulls[bestc].end(), segments[si].get_p()) == 0)
-            colorhulls[bestc].push_back(segments[si].get_p());
-        if (std::count(colorhulls[bestc].begin(), colorhulls[bestc].end(), segments[si].get_q()) == 0)
-            colorhulls[bestc].push_back(segments[si].get_q());
-        colorhulls[bestc] = convex_hull(colorhulls[bestc]);
+        if (bestc < 0)
+        {
+            colorhulls.emplace_back();
+            bestc = colorhulls.size() - 1;
+        }
+        add_to_hull(colorhulls[bestc], segments[si]);
 
         return bestc;
     }
@@ -140,6 +250,11 @@ public:
         DSatur::color([this](int si){ return bestAvailable(si); });
     }
 
+    virtual Solution *clone() const
+    {
+        return new DSatHull(*this);
+    }
+
     virtual ~DSatHull() = default;
 };
 
@@ -1,8 +1,10 @@
 #ifndef DSATUR
 #define DSATUR
 
-#include <unordered_set>
+#include <set>
 #include <cstdlib>
+#include <cstdint>
+#include <memory>
 
 #include "solution.hpp"
 
@@ -10,36 +12,65 @@
  * @brief The DSatur class
  * Implementation of the DSatur algorithm.
  * This is similar to the greedy algorithm, but the order of the segments is computed dynamically.
- * In this class, we first color segments that cross segments of many different colors
+ * In this class, we first color segments that cross segments of many different colors.
+ * The uncolored segments are kept in buckets by saturation, each bucket sorted by
+ * degree, and the colors crossing each segment are a bitset, so that coloring a
+ * segment only goes through the precomputed list of the segments crossing it
  */
 class DSatur : public Solution {
 protected:
-    std::vector<std::vector<bool>> neighbor_colors;
+    std::shared_ptr<const Crossings> crossings; // data structure encoding the crossing between segments
+    std::vector<uint64_t> neighbor_colors; // neighbor_colors[si*stride+w] = w-th word of the bitset of the colors crossing the si-th segment
+    size_t stride = 1; // number of words of the bitset of each segment
     std::vector<int> dsat; // dsat[i] = number of different colors of the segments crossing the i-th segment
     std::vector<int> degree; // degree[i] = number of segments crossing the i-th segment
+    std::vector<std::set<std::pair<int,int>>> buckets; // buckets[d] = (-degree, index) of the uncolored segments with dsat d
 
     /**
-     * @brief build_deg
-     * Compute the degree of each segment
+     * @brief has_neighbor_color
+     * @return True if a segment of color c crosses si
      */
-    void build_deg()
+    bool has_neighbor_color(int si, unsigned c) const
     {
-        for (const Segment &s : segments)
+        const size_t w = c >> 6;
+        return w < stride && ((neighbor_colors[si * stride + w] >> (c & 63)) & 1);
+    }
+
+    /**
+     * @brief add_neighbor_color
+     * Mark the color c as crossing si
+     * @return True if it was not marked
+     */
+    bool add_neighbor_color(int si, unsigned c)
+    {
+        const size_t w = c >> 6;
+        if (w >= stride)
         {
-            int isec = 0;
-            for (const Segment &t : segments)
-                if (s.cross(t))
-                    isec++;
-            degree.push_back(isec);
+            const size_t new_stride = std::max(2 * stride, w + 1);
+            std::vector<uint64_t> grown(segments.size() * new_stride, 0);
+            for (size_t sj = 0; sj < segments.size(); sj++)
+                std::copy_n(neighbor_colors.begin() + sj * stride, stride, grown.begin() + sj * new_stride);
+            neighbor_colors.swap(grown);
+            stride = new_stride;
         }
+        uint64_t &word = neighbor_colors[si * stride + w];
+        const uint64_t bit = uint64_t(1) << (c & 63);
+        if (word & bit)
+            return false;
+        word |= bit;
+        return true;
     }
 
     // First color available
     int first_available(int si) const
     {
-        unsigned int c;
-        for (c = 0; c < neighbor_colors[si].size() && neighbor_colors[si][c]; c++) {}
-        return c;
+        for (size_t w = 0; w < stride; w++)
+        {
+            const uint64_t available = ~neighbor_colors[si * stride + w];
+            if (available)
+                return w * 64 + __builtin_ctzll(available);
+        }
+        return stride * 64;
     }
 
     /**
@@ -48,65 +79,58 @@ protected:
      * the color for each vertex
      * @param colorChoice
      */
-    void color(auto&& colorChoice)
+    template <typename Choice>
+    void color(Choice &&colorChoice)
     {
         clearSol();
-        std::unordered_set<int> uncolored;
+        buckets.assign(1, {});
         for (unsigned int si = 0; si < segments.size(); si++) // initialize uncolored segments
-            uncolored.insert(si);
+            buckets[0].insert(std::make_pair(-degree[si], si));
 
-        while (uncolored.size())
+        int maxdsat = 0;
+        for (unsigned int n = 0; n < segments.size(); n++)
         {
-            int maxdsat = -1;
-            for (unsigned int si: uncolored)
-                maxdsat = std::max(maxdsat, dsat[si]);
-
-            std::vector<std::tuple<int,int,int>> candidates;
-            for (int si : uncolored) {
-                if (dsat[si] == maxdsat)
-                    candidates.push_back(std::make_tuple(-dsat[si], -degree[si], si));
-            }
+            while (buckets[maxdsat].empty())
+                maxdsat--;
 
-            sort(candidates.begin(), candidates.end());
-            int r = rand() % (std::min((int)candidates.size(), 8));
-            int vi = std::get<2>(candidates[r]);
+            // choose at random among the 8 segments of highest degree with the highest dsat
+            std::set<std::pair<int,int>> &candidates = buckets[maxdsat];
+            auto it = candidates.begin();
+            std::advance(it, rng() % (std::min((int)candidates.size(), 8)));
+            int vi = it->second;
+            candidates.erase(it);
             unsigned int c = colorChoice(vi);
             colorv[vi] = c;
-            uncolored.erase(vi);
-            neighbor_colors[vi].clear();
 
-            for (int si : uncolored)
+            for (int si : crossings->neighbors(vi))
             {
-                if (segments[si].cross(segments[vi]))
+                if (colorv[si] < 0 && add_neighbor_color(si, c))
                 {
-                    if (neighbor_colors[si].size() < c+1)
-                    {
-                        neighbor_colors[si].resize(c+1);
-                    }
-                    if (!neighbor_colors[si][c])
-                    {
-                        neighbor_colors[si][c] = true;
-                        dsat[si]++;
-                    }
+                    buckets[dsat[si]].erase(std::make_pair(-degree[si], si));
+                    dsat[si]++;
+                    if ((int) buckets.size() <= dsat[si])
+                        buckets.emplace_back();
+                    buckets[dsat[si]].insert(std::make_pair(-degree[si], si));
+                    maxdsat = std::max(maxdsat, dsat[si]);
                 }
             }
         }
     }
 
 public:
-    DSatur(Parameters param) : Solution(param)
+    DSatur(Parameters param) : Solution(param), crossings(build_crossings())
     {
-        neighbor_colors = std::vector<std::vector<bool>>(segments.size());
+        neighbor_colors = std::vector<uint64_t>(segments.size() * stride, 0);
         dsat = std::vector<int>(segments.size());
-        build_deg();
+        for (unsigned int si = 0; si < segments.size(); si++)
+            degree.push_back(crossings->degree(si));
     }
 
     virtual void clearSol() {
         Solution::clear();
         for (int &x : dsat)
             x = 0;
-        for (auto &x : neighbor_colors)
-            x.clear();
+        std::fill(neighbor_colors.begin(), neighbor_colors.end(), 0);
     }
 
     /**
@@ -117,6 +141,11 @@ public:
         color([this](int si){ return first_available(si); });
     }
 
+    virtual Solution *clone() const
+    {
+        return new DSatur(*this);
+    }
+
     virtual ~DSatur() = default;
 };
 
@@ -2,18 +2,87 @@
 #define GREEDY
 
 #include <cstdlib>
+#include <cstdint>
 #include <vector>
+#include <memory>
 #include "solution.hpp"
 
 /**
  * @brief The Greedy class
  * Implementation of the greedy algorithm.
  * Segments are traversed in any order. For each segment, we assign them the label
- * of the first color that is compatible with it (which does not have a segment intersecting it)
+ * of the first color that is compatible with it (which does not have a segment intersecting it).
+ * With the parameter precompute, the crossings are computed once, and each color
+ * also is a bitset of its segments, so that testing a color is an AND of words
  */
 class Greedy : public Solution {
 protected:
     std::vector<std::vector<int>> classes; // classes[c] = list of (indices of) segments labeled as c
+    std::shared_ptr<const Crossings> crossings; // precomputed crossings, nullptr without the parameter precompute
+    std::vector<std::vector<uint64_t>> class_bits; // class_bits[c] = bitset of the segments labeled as c, with the precomputed crossings
+    std::vector<int> colored; // (indices of) the colored segments, in the order they were colored
+
+    /**
+     * @brief crosses_class
+     * @return True if the si-th segment crosses a segment of the color c
+     */
+    bool crosses_class(int si, unsigned c) const
+    {
+        if (!crossings)
+            return batch.cross_any(si, classes[c].data(), classes[c].size());
+        const uint64_t *bits = class_bits[c].data();
+        if (const uint64_t *row = crossings->row(si))
+        {
+            for (size_t w = 0; w < crossings->nb_words(); w++)
+                if (row[w] & bits[w])
+                    return true;
+            return false;
+        }
+        for (int sj : crossings->neighbors(si))
+            if ((bits[sj >> 6] >> (sj & 63)) & 1)
+                return true;
+        return false;
+    }
+
+    /**
+     * @brief add_to_class
+     * Label the si-th segment as c
+     */
+    void add_to_class(int si, unsigned c)
+    {
+        classes[c].push_back(si);
+        if (crossings)
+            class_bits[c][si >> 6] |= uint64_t(1) << (si & 63);
+        colorv[si] = c;
+        colored.push_back(si);
+    }
+
+    /**
+     * @brief rewind
+     * Uncolor the segments colored after the n first ones, so that the solution is
+     * the one the greedy algorithm had after coloring them. The segments colored last
+     * are at the end of their colors, and the colors created last are at the end
+     * @param n
+     */
+    void rewind(size_t n)
+    {
+        while (colored.size() > n)
+        {
+            const int si = colored.back();
+            const int c = colorv[si];
+            colored.pop_back();
+            classes[c].pop_back();
+            if (crossings)
+                class_bits[c][si >> 6] &= ~(uint64_t(1) << (si & 63));
+            colorv[si] = -1;
+            if (classes[c].empty())
+            {
+                classes.pop_back();
+                if (crossings)
+                    class_bits.pop_back();
+            }
+        }
+    }
 
     /**
      * @brief firstAvailable
@@ -25,36 +94,19 @@ protected:
     {
         unsigned int c;
         for (c = 0; c < classes.size(); c++)
-        {
-            bool valid = true;
-            for (int ti : classes[c])
-                if (segments[si].cross(segments[ti]))
-                {
-                    valid = false;
-                    break;
-                }
-            if (valid)
+            if (!crosses_class(si, c))
                 break;
-        }
 
         if (c == classes.size())
+        {
             classes.push_back({});
+            if (crossings)
+                class_bits.emplace_back(crossings->nb_words(), 0);
+        }
 
         return c;
     }
 
-    /**
-     * @brief build_colorv
-     * Make the map `colorv`: segments -> color
-     */
-    void build_colorv()
-    {
-        for (unsigned int c = 0; c < classes.size(); c++)
-            for (int vi : classes[c])
-                colorv[vi] = c;
-    }
-
-
     /**
      * @brief greedy
      * Run the greedy algorithm on a list of segments
@@ -67,14 +119,16 @@ protected:
             const int vi = uncolored.back();
             uncolored.pop_back();
             unsigned int c = first_available(vi);
-            classes[c].push_back(vi);
+            add_to_class(vi, c);
         }
-        build_colorv();
     }
 
 public:
     Greedy(Parameters param) : Solution(param)
-    {}
+    {
+        if (param.precompute)
+            crossings = build_crossings();
+    }
 
     /**
      * @brief clearSol
@@ -84,6 +138,8 @@ public:
     {
         Solution::clear();
         classes.clear();
+        class_bits.clear();
+        colored.clear();
     }
 
     /**
@@ -7,8 +7,12 @@
 #include <map>
 #include <algorithm>
 #include <string>
+#include <memory>
+#include <sstream>
 
 #include "primitives.hpp"
+#include "batch.hpp"
+#include "crossings.hpp"
 
 /**
  * @brief The Instance class
@@ -20,10 +24,12 @@ class Instance
 protected:
     Parameters param;
     std::vector<Segment> segments;
+    SegmentBatch batch; // structure-of-arrays copy of the segments
     std::string instance_id; // id of the instance
     std::string author; // name of the author of this solution
     std::string host; // machine computing this solution
     const std::chrono::system_clock::time_point start_time = std::chrono::system_clock::now();
+    double resumed_sec = 0; // running time of the run that we resume, if any
 
     /**
      * @brief read_json
@@ -84,6 +90,7 @@ protected:
             Point q(x_vec[j_vec[k]], y_vec[j_vec[k]]);
             segments.push_back(Segment(p, q));
         }
+        batch = SegmentBatch(segments);
 
         instance_id = doc["id"].GetString();
         author = "shadoks";
@@ -94,17 +101,37 @@ protected:
 
     virtual ~Instance() = default;
 
+    /**
+     * @brief build_crossings
+     * Precompute all the intersections, or load them from the cache directory
+     * @return The crossings, to be shared by the solvers of the instance
+     */
+    std::shared_ptr<const Crossings> build_crossings() const
+    {
+        std::string cache;
+        if (!param.cache.empty())
+        {
+            std::ostringstream oss;
+            oss << param.cache << "/" << instance_id << "." << std::hex << Crossings::hash(segments) << ".crossings";
+            cache = oss.str();
+        }
+        std::shared_ptr<Crossings> built = std::make_shared<Crossings>();
+        built->build(segments, batch, param.threads, cache);
+        return built;
+    }
+
 
 public:
     /**
      * @brief elapsed_sec
-     * @return Elapsed seconds since we read this instance
+     * @return Elapsed seconds since we read this instance, plus the running time of
+     * the run that we resume
      */
     double elapsed_sec() const
     {
         auto cur_time = std::chrono::system_clock::now();
         std::chrono::duration<double> elapsed_seconds = cur_time - start_time;
-        return elapsed_seconds.count();
+        return resumed_sec + elapsed_seconds.count();
     }
 };
 
@@ -0,0 +1,151 @@
+#ifndef ITERATED
+#define ITERATED
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <numeric>
+
+#include "greedy.hpp"
+
+/**
+ * @brief The IteratedGreedy class
+ * Implementation of the iterated greedy algorithm of Culberson.
+ * The greedy algorithm colors the segments color by color. The segments of a color
+ * do not cross, so that they get at most the same number of colors, in any order of
+ * the colors. We repeat this with the colors in reverse order, by decreasing size,
+ * or in a random order, so that the number of colors never increases.
+ * The colors are bitsets of their segments, so that testing a color is an AND of words.
+ * Several workers run in parallel, and adopt the best solution as soon as it is
+ * better than their own
+ */
+class IteratedGreedy : public Greedy
+{
+    /**
+     * @brief The Board struct
+     * Best solution found by the workers, shared by all of them
+     */
+    struct Board {
+        std::mutex mutex;
+        int best = 0; // number of colors of the best solution
+        std::vector<int> colorv; // best solution
+    };
+
+    std::shared_ptr<Board> board;
+    long passes = 0; // number of greedy passes of the worker
+
+    /**
+     * @brief build_classes
+     * Build the colors from `colorv`
+     */
+    void build_classes()
+    {
+        const std::vector<int> labels = colorv;
+        const int k = numColors();
+        clearSol();
+        classes.assign(k, {});
+        class_bits.assign(k, std::vector<uint64_t>(crossings->nb_words(), 0));
+        for (unsigned si = 0; si < segments.size(); si++)
+            add_to_class(si, labels[si]);
+    }
+
+    /**
+     * @brief recolor
+     * Run the greedy algorithm on the segments sorted by color, with the colors in
+     * reverse order (half of the passes), by decreasing size, or in a random order
+     */
+    void recolor()
+    {
+        std::vector<int> order(classes.size());
+        std::iota(order.begin(), order.end(), 0);
+        const unsigned r = rng() % 10;
+        if (r < 5)
+            std::reverse(order.begin(), order.end());
+        else if (r < 8)
+            std::stable_sort(order.begin(), order.end(), [this](int c1, int c2) {
+                return classes[c1].size() > classes[c2].size();
+            });
+        else
+            std::shuffle(order.begin(), order.end(), rng);
+
+        // greedy colors the segments from the end of uncolored
+        std::vector<int> uncolored;
+        for (auto c = order.rbegin(); c != order.rend(); ++c)
+            uncolored.insert(uncolored.end(), classes[*c].rbegin(), classes[*c].rend());
+        clearSol();
+        greedy(uncolored);
+        passes++;
+    }
+
+    /**
+     * @brief improve
+     * Run greedy passes until the maximum running time, and share the improvements
+     */
+    void improve()
+    {
+        while (elapsed_sec() < param.max_run_time)
+        {
+            {
+                std::lock_guard<std::mutex> lock(board->mutex);
+                if (board->best < (int) classes.size())
+                {
+                    colorv = board->colorv;
+                    build_classes();
+                }
+            }
+            recolor();
+
+            std::lock_guard<std::mutex> lock(board->mutex);
+            if ((int) classes.size() < board->best)
+            {
+                board->best = classes.size();
+                board->colorv = colorv;
+                std::cout << "Colors: " << board->best << " after " << elapsed_sec() << " seconds and " << passes << " passes ";
+                write_sol();
+            }
+        }
+    }
+
+public:
+    IteratedGreedy(Parameters param) : Greedy(param), board(std::make_shared<Board>())
+    {
+        if (!crossings)
+            crossings = build_crossings();
+    }
+
+    /**
+     * @brief color
+     * Start from the solution read, or from a greedy solution, and improve it with
+     * `threads` workers until the maximum running time. The solution is the best one
+     * at the end
+     */
+    virtual void color()
+    {
+        if (std::count(colorv.begin(), colorv.end(), -1) > 0)
+            Greedy::color();
+        else
+            build_classes();
+        board->best = classes.size();
+        board->colorv = colorv;
+        std::clog << "Iterated greedy starts with " << board->best << " colors" << std::endl;
+
+        std::vector<std::unique_ptr<IteratedGreedy>> copies;
+        for (int t = 1; t < param.threads; t++)
+        {
+            copies.emplace_back(new IteratedGreedy(*this));
+            copies.back()->seed(t);
+        }
+        std::vector<std::thread> workers;
+        for (auto &copy : copies)
+            workers.emplace_back(&IteratedGreedy::improve, copy.get());
+        improve();
+        for (std::thread &worker : workers)
+            worker.join();
+        colorv = board->colorv;
+    }
+
+    virtual ~IteratedGreedy() = default;
+};
+
+#endif // ITERATED
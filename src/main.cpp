@@ -1,6 +1,10 @@
 // g++ -Wall -std=c++20 -Ofast -o solver solver.cpp
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include "../include/cxxopts.hpp"
 #include "greedy.hpp"
 #include "angle.hpp"
@@ -8,6 +12,9 @@
 #include "dsatur.hpp"
 #include "dsathull.hpp"
 #include "conflict.h"
+#include "tabucol.hpp"
+#include "rlf.hpp"
+#include "iterated.hpp"
 
 cxxopts::Options options("Shadoks CG:SHOP 2022 solver", "Partition into plane subgraphs");
 cxxopts::ParseResult par;
@@ -17,10 +24,14 @@ void parse(int argc, char **argv) {
   ("help", "Print help")
   ("i,instance", "Instance file name (required)", cxxopts::value<std::string>())
   ("s,solution", "Solution file name", cxxopts::value<std::string>())
-  ("a,algorithm", "Algorithm name (required: greedy, angle, bad, dsatur, dsathull, conflict)", cxxopts::value<std::string>())
+  ("a,algorithm", "Algorithm name (required: greedy, angle, bad, dsatur, dsathull, rlf, conflict, tabucol, iterated)", cxxopts::value<std::string>())
   ("t,time", "Maximum time to start a new repetition in seconds", cxxopts::value<int>()->default_value("-1"))
   ("r,repetitions", "Maximum number of repetitions", cxxopts::value<int>()->default_value("100"))
   ("p,parameters", "Parameters file name", cxxopts::value<std::string>())
+  ("threads", "Number of threads", cxxopts::value<int>())
+  ("cache", "Directory of the crossing cache files", cxxopts::value<std::string>())
+  ("precompute", "Precompute the crossings for greedy, angle and bad")
+  ("resume", "Checkpoint file of the conflict optimizer to resume from", cxxopts::value<std::string>())
   ;
   
   par = options.parse(argc, argv);
@@ -35,10 +46,68 @@ Parameters parse_parameters()
         param.algorithm = par["algorithm"].as<std::string>();
     if (par.count("parameters"))
         param.read(par["parameters"].as<std::string>());
+    if (par.count("threads"))
+        param.threads = par["threads"].as<int>();
+    if (par.count("cache"))
+        param.cache = par["cache"].as<std::string>();
+    if (par.count("precompute"))
+        param.precompute = true;
+    if (par.count("resume"))
+        param.resume = par["resume"].as<std::string>();
     return param;
 }
 
 
+/**
+ * @brief run_repetitions
+ * Run the repetitions of an algorithm for initial solutions, and write each solution
+ * better than the previous ones. With several threads, each thread runs repetitions
+ * with its own copy of the solver, if the solver can be copied
+ * @param solver
+ * @param repetitions Maximum number of repetitions
+ * @param maxSec Maximum time to start a new repetition in seconds
+ * @param threads Number of threads
+ */
+void run_repetitions(Solution *solver, int repetitions, double maxSec, int threads)
+{
+    std::vector<std::unique_ptr<Solution>> copies;
+    for (int t = 1; t < std::min(threads, repetitions); t++)
+    {
+        Solution *copy = solver->clone();
+        if (!copy)
+            break;
+        copy->seed(t);
+        copies.emplace_back(copy);
+    }
+
+    std::atomic<int> next_rep(0);
+    std::mutex mutex;
+    int best = std::numeric_limits<int>::max();
+    auto run = [&](Solution *s)
+    {
+        while (next_rep++ < repetitions && s->elapsed_sec() < maxSec)
+        {
+            s->color();
+            std::lock_guard<std::mutex> lock(mutex);
+            std::cout << "Colors: " << s->numColors();
+            if (s->numColors() < best)
+            {
+                s->write_sol();
+                best = s->numColors();
+            }
+            else
+                std::cout << std::endl;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto &copy : copies)
+        workers.emplace_back(run, copy.get());
+    run(solver);
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
 int main(int argc, char **argv) {
     parse(argc, argv);
 
@@ -61,7 +130,7 @@ int main(int argc, char **argv) {
     Solution *solver;
 
     // Compute initial solution
-    if (param.algorithm != "conflict")
+    if (param.algorithm != "conflict" && param.algorithm != "tabucol" && param.algorithm != "iterated")
     {
         if (param.algorithm == "greedy")
         {
@@ -76,6 +145,8 @@ int main(int argc, char **argv) {
             solver = new DSatur(param);
         else if (param.algorithm == "dsathull")
             solver = new DSatHull(param);
+        else if (param.algorithm == "rlf")
+            solver = new RecursiveLargestFirst(param);
         else
         {
             std::cerr << "Unknown algorithm: " << param.algorithm << std::endl;
@@ -84,23 +155,16 @@ int main(int argc, char **argv) {
         }
 
         // Run the algorithms for initial solutions
-        int best = std::numeric_limits<int>::max();
-        for (int rep = 0; rep < repetitions && solver->elapsed_sec() < maxSec; rep++)
-        {
-            solver->color();
-            std::cout << "Colors: " << solver->numColors();
-            if (solver->numColors() < best)
-            {
-                solver->write_sol();
-                best = solver->numColors();
-            }
-            else
-                std::cout << std::endl;
-        }
+        run_repetitions(solver, repetitions, maxSec, param.threads);
     }
-    else // Run the conflict optimizer
+    else // Run the conflict optimizer, TabuCol or the iterated greedy, which write their improvements
     {
-        solver = new Conflict(param);
+        if (param.algorithm == "tabucol")
+            solver = new TabuCol(param);
+        else if (param.algorithm == "iterated")
+            solver = new IteratedGreedy(param);
+        else
+            solver = new Conflict(param);
         solver->color();
     }
 
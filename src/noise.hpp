@@ -0,0 +1,104 @@
+#ifndef NOISE
+#define NOISE
+
+#include <cstdint>
+#include <cmath>
+
+/**
+ * @brief The Noise class
+ * Generator of normally distributed numbers, for the noise of the conflict optimizer.
+ * The uniform numbers come from a xorshift generator, and are turned into normal
+ * numbers by the Box-Muller transform, a whole batch at once.
+ * Each worker has its own generator, so that no state is shared between threads
+ */
+class Noise
+{
+public:
+    static constexpr int batch = 256; // number of normal numbers generated at once
+
+private:
+    uint64_t state[2]; // state of the xorshift128+ generator
+    double normals[batch]; // standard normal numbers not used yet
+    int next = batch; // index of the next number to use in normals
+    double mean = 0;
+    double deviation = 1;
+
+    uint64_t random()
+    {
+        uint64_t s1 = state[0];
+        const uint64_t s0 = state[1];
+        state[0] = s0;
+        s1 ^= s1 << 23;
+        state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+        return state[1] + s0;
+    }
+
+    /**
+     * @brief uniform
+     * @return A uniform number in (0, 1]
+     */
+    double uniform()
+    {
+        return ((random() >> 11) + 1) * 0x1.0p-53;
+    }
+
+    void refill()
+    {
+        for (int k = 0; k < batch; k += 2)
+        {
+            const double r = std::sqrt(-2 * std::log(uniform()));
+            const double theta = 2 * M_PI * uniform();
+            normals[k] = r * std::cos(theta);
+            normals[k + 1] = r * std::sin(theta);
+        }
+        next = 0;
+    }
+
+public:
+    Noise()
+    {
+        seed(0);
+    }
+
+    /**
+     * @brief seed
+     * Restart the generator from a seed, with the splitmix64 generator
+     * @param s
+     */
+    void seed(uint64_t s)
+    {
+        for (uint64_t &word : state)
+        {
+            uint64_t z = (s += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+        next = batch;
+    }
+
+    /**
+     * @brief set
+     * Set the distribution of the generated numbers
+     * @param _mean
+     * @param _deviation Standard deviation
+     */
+    void set(double _mean, double _deviation)
+    {
+        mean = _mean;
+        deviation = _deviation;
+    }
+
+    /**
+     * @brief operator ()
+     * @return A normal number of the current mean and standard deviation
+     */
+    double operator()()
+    {
+        if (next == batch)
+            refill();
+        return mean + deviation * normals[next++];
+    }
+};
+
+#endif // NOISE
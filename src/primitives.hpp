@@ -23,6 +23,7 @@ struct Parameters
     std::string instance_name = "";
     std::string solution_name = "";
     std::string info_name = "";
+    std::string cache = ""; // directory of the crossing cache files
     std::string algorithm = "greedy";
     double power = 1.2;
     double noise_mean = 1;
@@ -35,6 +36,10 @@ struct Parameters
     int loop_time = 3600;
     std::vector<double> power_loop = {1.1, 1.2, 1.3, 1.5, 2.0};
     long loop_index = 0;
+    int threads = 1;
+    bool precompute = false; // the greedy algorithms use the precomputed crossings instead of the geometry
+    int checkpoint = 0; // seconds between two checkpoints of the conflict optimizer, 0 for no checkpoint
+    std::string resume = ""; // checkpoint file to resume from
 
     void read(const std::string &filename)
     {
@@ -66,6 +71,8 @@ struct Parameters
             solution_name = doc["solution"].GetString();
         if (doc.HasMember("info"))
             info_name = doc["info"].GetString();
+        if (doc.HasMember("cache"))
+            cache = doc["cache"].GetString();
         if (doc.HasMember("algorithm"))
             algorithm = doc["algorithm"].GetString();
         if (doc.HasMember("power"))
@@ -83,17 +90,41 @@ struct Parameters
         if (doc.HasMember("easy"))
             easy = doc["easy"].GetBool();
         if (doc.HasMember("loop"))
-        {
             loop = doc["loop"].GetBool();
-            if (loop)
-                power = 1.1;
-        }
         if (doc.HasMember("loop_time"))
             loop_time = doc["loop_time"].GetInt();
+        if (doc.HasMember("power_loop"))
+        {
+            power_loop.clear();
+            for (auto &value : doc["power_loop"].GetArray())
+                power_loop.push_back(value.GetDouble());
+        }
+        if (loop && power_loop.empty())
+        {
+            std::cerr << "The power loop cannot be empty" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // The power loop starts with its current power, whatever the power given
+        if (loop)
+        {
+            const double first = power_loop[loop_index % power_loop.size()];
+            if (doc.HasMember("power") && power != first)
+                std::clog << "The power " << power << " is ignored, the power loop starts with " << first << std::endl;
+            power = first;
+        }
+        if (doc.HasMember("threads"))
+            threads = doc["threads"].GetInt();
+        if (doc.HasMember("precompute"))
+            precompute = doc["precompute"].GetBool();
+        if (doc.HasMember("checkpoint"))
+            checkpoint = doc["checkpoint"].GetInt();
+        if (doc.HasMember("resume"))
+            resume = doc["resume"].GetString();
 
         std::clog << "{ instance: " << instance_name << ", "
                   << "solution: " << solution_name << ", "
                   << "info: " << info_name << ", "
+                  << "cache: " << cache << ", "
                   << "power: " << power << ", "
                   << "noise_mean: " << noise_mean << ", "
                   << "noise_var: " << noise_var << ", "
@@ -102,7 +133,15 @@ struct Parameters
                   << "dfs: " << dfs << ", "
                   << "easy: " << easy << ", "
                   << "loop: " << loop << ", "
-                  << "loop_time: " << loop_time << " }" << std::endl;
+                  << "loop_time: " << loop_time << ", "
+                  << "power_loop: [";
+        for (size_t p = 0; p < power_loop.size(); p++)
+            std::clog << (p ? ", " : "") << power_loop[p];
+        std::clog << "], "
+                  << "threads: " << threads << ", "
+                  << "precompute: " << precompute << ", "
+                  << "checkpoint: " << checkpoint << ", "
+                  << "resume: " << resume << " }" << std::endl;
     }
 };
 
@@ -217,6 +256,27 @@ public:
         return (double) d.y / d.x;
     }
 
+    /**
+     * @brief compare_slope
+     * Compare the slopes exactly, a vertical segment having the slope +inf if it goes
+     * up and -inf if it goes down, as slope()
+     * @return -1, 0 or 1 if the slope of this segment is less, equal or more than the one of t
+     */
+    int compare_slope(const Segment &t) const {
+        Point d = q - p, e = t.q - t.p;
+        if (d.x < 0) // same slope with d.x >= 0
+            d = Point(-d.x, -d.y);
+        if (e.x < 0)
+            e = Point(-e.x, -e.y);
+        if (d.x == 0 || e.x == 0) { // -inf, finite or +inf
+            const int a = d.x ? 0 : (d.y > 0 ? 1 : -1), b = e.x ? 0 : (e.y > 0 ? 1 : -1);
+            if (a != b || a != 0)
+                return (a > b) - (a < b);
+        }
+        const i64 lhs = d.y * e.x, rhs = e.y * d.x;
+        return (lhs > rhs) - (lhs < rhs);
+    }
+
     friend bool operator==(const Segment &s, const Segment &t) {
         return s.p == t.p && s.q == t.q;
     }
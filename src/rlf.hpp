@@ -0,0 +1,171 @@
+#ifndef RLF
+#define RLF
+
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <tuple>
+#include <memory>
+
+#include "solution.hpp"
+
+/**
+ * @brief The RecursiveLargestFirst class
+ * Implementation of the Recursive Largest First algorithm.
+ * The colors are built one at a time. A color starts with the uncolored segment
+ * crossing the most uncolored segments. Then, among the candidates (the uncolored
+ * segments crossing no segment of the color), we add the one crossing the most
+ * segments that cannot be added to the color anymore, and the fewest candidates.
+ * The uncolored segments and the candidates are bitsets (the excluded segments being
+ * the uncolored segments that are not candidates). The counts of each candidate are
+ * updated going through the candidates crossing a newly excluded segment, in
+ * O(degree) with a list and O(m/64) with a bitset. The next segment is found going
+ * through all the candidates, a word at a time, so that choosing the s segments of
+ * a color takes O(s (m/64 + c)) time, c being the number of candidates when the
+ * color starts
+ */
+class RecursiveLargestFirst : public Solution {
+    std::shared_ptr<const Crossings> crossings; // data structure encoding the crossing between segments
+    size_t words = 0; // number of words of a bitset of segments
+    std::vector<uint64_t> uncolored; // bitset of the uncolored segments
+    std::vector<uint64_t> candidates; // bitset of the segments that can be added to the current color
+    std::vector<int> uncolored_degree; // uncolored_degree[i] = number of uncolored segments crossing the i-th segment
+    std::vector<int> nb_excluded; // nb_excluded[i] = number of excluded segments crossing the i-th segment
+    std::vector<int> nb_candidates; // nb_candidates[i] = number of candidates crossing the i-th segment
+    std::vector<unsigned> tag; // random tag of each segment, to break the ties
+
+    static bool test(const std::vector<uint64_t> &bits, int si)
+    {
+        return (bits[si >> 6] >> (si & 63)) & 1;
+    }
+
+    static void set(std::vector<uint64_t> &bits, int si, bool value)
+    {
+        if (value)
+            bits[si >> 6] |= uint64_t(1) << (si & 63);
+        else
+            bits[si >> 6] &= ~(uint64_t(1) << (si & 63));
+    }
+
+    /**
+     * @brief for_each_crossing
+     * Call f on each segment of the bitset `bits` crossing si. The word of `bits` is
+     * read before calling f on its segments, so that f may change the bitset
+     */
+    template <typename F>
+    void for_each_crossing(int si, const std::vector<uint64_t> &bits, F &&f) const
+    {
+        if (const uint64_t *row = crossings->row(si))
+        {
+            for (size_t w = 0; w < words; w++)
+                for (uint64_t word = row[w] & bits[w]; word; word &= word - 1)
+                    f(w * 64 + __builtin_ctzll(word));
+        }
+        else
+            for (int sj : crossings->neighbors(si))
+                if (test(bits, sj))
+                    f(sj);
+    }
+
+    /**
+     * @brief exclude
+     * The si-th segment cannot be added to the current color anymore. The candidates
+     * crossing it cross one more excluded segment and one less candidate
+     */
+    void exclude(int si)
+    {
+        set(candidates, si, false);
+        for_each_crossing(si, candidates, [this](int sj) {
+            nb_excluded[sj]++;
+            nb_candidates[sj]--;
+        });
+    }
+
+    /**
+     * @brief add_to_color
+     * Give the color c to the si-th segment, and exclude the candidates crossing it
+     */
+    void add_to_color(int si, int c)
+    {
+        colorv[si] = c;
+        set(candidates, si, false);
+        set(uncolored, si, false);
+        for_each_crossing(si, uncolored, [this](int sj) { uncolored_degree[sj]--; });
+        for_each_crossing(si, candidates, [this](int sj) { exclude(sj); });
+    }
+
+    /**
+     * @brief next_candidate
+     * @return The candidate crossing the most excluded segments, and then the fewest
+     * candidates, or -1 if there is no candidate
+     */
+    int next_candidate() const
+    {
+        int best = -1;
+        for (size_t w = 0; w < words; w++)
+            for (uint64_t word = candidates[w]; word; word &= word - 1)
+            {
+                const int si = w * 64 + __builtin_ctzll(word);
+                if (best < 0 || std::make_tuple(nb_excluded[si], -nb_candidates[si], tag[si]) > std::make_tuple(nb_excluded[best], -nb_candidates[best], tag[best]))
+                    best = si;
+            }
+        return best;
+    }
+
+public:
+    RecursiveLargestFirst(Parameters param) : Solution(param), crossings(build_crossings())
+    {
+        words = (segments.size() + 63) / 64;
+    }
+
+    virtual Solution *clone() const
+    {
+        return new RecursiveLargestFirst(*this);
+    }
+
+    /**
+     * @brief color
+     * Run the algorithm
+     */
+    virtual void color()
+    {
+        const int m = segments.size();
+        clear();
+        uncolored.assign(words, 0);
+        for (int si = 0; si < m; si++)
+            set(uncolored, si, true);
+        uncolored_degree.resize(m);
+        for (int si = 0; si < m; si++)
+            uncolored_degree[si] = crossings->degree(si);
+        nb_excluded.assign(m, 0);
+        nb_candidates.resize(m);
+        tag.resize(m);
+        for (unsigned &t : tag)
+            t = rng();
+
+        for (int c = 0, nb_uncolored = m; nb_uncolored > 0; c++)
+        {
+            // The first segment of the color crosses the most uncolored segments
+            candidates = uncolored;
+            int first = -1;
+            for (int si = 0; si < m; si++)
+                if (test(uncolored, si))
+                {
+                    nb_excluded[si] = 0;
+                    nb_candidates[si] = uncolored_degree[si];
+                    if (first < 0 || std::make_pair(uncolored_degree[si], tag[si]) > std::make_pair(uncolored_degree[first], tag[first]))
+                        first = si;
+                }
+
+            for (int si = first; si >= 0; si = next_candidate())
+            {
+                add_to_color(si, c);
+                nb_uncolored--;
+            }
+        }
+    }
+
+    virtual ~RecursiveLargestFirst() = default;
+};
+
+#endif // RLF
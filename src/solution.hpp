@@ -10,6 +10,7 @@
 #include <stack>
 #include <unistd.h>
 #include <string>
+#include <random>
 
 #include "../include/rapidjson/document.h"
 #include "../include/rapidjson/istreamwrapper.h"
@@ -29,6 +30,7 @@ class Solution : public Instance
 protected:
     std::list<long> clique;
     std::vector<int> colorv; // colorv[i] is the label of the i-th segment. -1 means unlabeled
+    std::mt19937 rng; // random generator of the solver, so that copies of the solver can run in parallel
 
     Solution(Parameters param) : Instance(param) {
         clear();
@@ -38,6 +40,26 @@ protected:
 public:
     virtual void color() = 0;
 
+    /**
+     * @brief clone
+     * @return A copy of the solver, which can run its repetitions in another thread
+     * with its own solution, or nullptr if the repetitions of this solver cannot run
+     * in parallel
+     */
+    virtual Solution *clone() const
+    {
+        return nullptr;
+    }
+
+    /**
+     * @brief seed
+     * Restart the random generator of the solver from a seed
+     */
+    void seed(unsigned s)
+    {
+        rng.seed(s);
+    }
+
     /**
      * @brief clear
      * Clear, or reset a solution. Each segments has the label -1
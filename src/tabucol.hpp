@@ -0,0 +1,247 @@
+#ifndef TABUCOL
+#define TABUCOL
+
+#include <cstdlib>
+#include <vector>
+#include <limits>
+#include <memory>
+
+#include "solution.hpp"
+#include "crossings.hpp"
+#include "colorcounts.hpp"
+
+/**
+ * @brief The TabuCol class
+ * Implementation of the TabuCol local search.
+ * For a fixed number of colors k, every segment has a color, and we minimize the
+ * number of pairs of crossing segments of the same color. At each iteration, we
+ * move a conflicting segment to the color that decreases this number the most,
+ * and forbid the segment to go back to its old color for a few iterations (it is
+ * tabu). Once there are no conflicts, the solution is written and we remove a color.
+ * The conflict counts of each segment and color are updated in O(degree) per move
+ */
+class TabuCol : public Solution
+{
+    static constexpr int tenure_random = 10; // the tabu tenure is rng() % tenure_random + tenure_factor * number of conflicting segments
+    static constexpr double tenure_factor = 0.6;
+
+    std::shared_ptr<const Crossings> crossings; // data structure encoding the crossing between segments
+    ColorCounts color_counts; // number of segments of each color crossing each segment, without the weights
+    int k = 0; // number of colors
+    std::vector<long> tabu; // tabu[si*k+c] = iteration until which the si-th segment cannot move to the color c
+    std::vector<int> conflicted; // segments crossing a segment of their color, in no particular order
+    std::vector<int> conflicted_pos; // conflicted_pos[i] = position of the i-th segment in conflicted, -1 if it is not there
+    long nb_conflicts = 0; // number of pairs of crossing segments of the same color
+    long iteration = 0;
+
+    /**
+     * @brief update_conflicted
+     * Add the si-th segment to the conflicting segments, or remove it, depending on its color
+     */
+    void update_conflicted(int si)
+    {
+        const bool conflicting = colorv[si] >= 0 && color_counts.count(si, colorv[si]) > 0;
+        if (conflicting && conflicted_pos[si] < 0)
+        {
+            conflicted_pos[si] = conflicted.size();
+            conflicted.push_back(si);
+        }
+        else if (!conflicting && conflicted_pos[si] >= 0)
+        {
+            const int last = conflicted.back();
+            conflicted[conflicted_pos[si]] = last;
+            conflicted_pos[last] = conflicted_pos[si];
+            conflicted.pop_back();
+            conflicted_pos[si] = -1;
+        }
+    }
+
+    /**
+     * @brief move
+     * Give the color c to the si-th segment (which may be uncolored), keeping the
+     * conflict counts, the number of conflicts and the conflicting segments up to date
+     */
+    void move(int si, int c)
+    {
+        const int old = colorv[si];
+        if (old >= 0)
+        {
+            nb_conflicts -= color_counts.count(si, old);
+            color_counts.add(*crossings, si, old, -1, 1, false);
+        }
+        colorv[si] = c;
+        if (c >= 0)
+        {
+            nb_conflicts += color_counts.count(si, c);
+            color_counts.add(*crossings, si, c, 1, 1, false);
+        }
+        update_conflicted(si);
+        for (int sj : crossings->neighbors(si))
+            if (colorv[sj] == old || colorv[sj] == c)
+                update_conflicted(sj);
+    }
+
+    /**
+     * @brief least_conflicting_color
+     * @return The color with the fewest segments crossing si, ties broken at random
+     */
+    int least_conflicting_color(int si)
+    {
+        int best_c = 0, best_count = std::numeric_limits<int>::max(), ties = 0;
+        for (int c = 0; c < k; c++)
+        {
+            const int count = color_counts.count(si, c);
+            if (count < best_count)
+            {
+                best_c = c;
+                best_count = count;
+                ties = 1;
+            }
+            else if (count == best_count && rng() % ++ties == 0)
+                best_c = c;
+        }
+        return best_c;
+    }
+
+    /**
+     * @brief init_solution
+     * Start from the solution read, or from a greedy solution
+     */
+    void init_solution()
+    {
+        color_counts.assign(segments.size(), 1, false);
+        conflicted.clear();
+        conflicted_pos.assign(segments.size(), -1);
+        nb_conflicts = 0;
+        const std::vector<int> read = colorv;
+        std::fill(colorv.begin(), colorv.end(), -1);
+        k = 0;
+        for (unsigned si = 0; si < segments.size(); si++)
+        {
+            int c = read[si];
+            if (c < 0) // first color without conflict
+                for (c = 0; c < k && color_counts.count(si, c) > 0; c++) {}
+            k = std::max(k, c + 1);
+            move(si, c);
+        }
+        tabu.assign(segments.size() * k, 0);
+        std::clog << "TabuCol starts with " << k << " colors and " << nb_conflicts << " conflicts" << std::endl;
+    }
+
+    /**
+     * @brief drop_color
+     * Remove the smallest color, the last color taking its label, and give the
+     * segments that were in it the color crossing the fewest of their segments
+     */
+    void drop_color()
+    {
+        std::vector<int> size(k, 0);
+        for (int c : colorv)
+            size[c]++;
+        const int dropped = std::min_element(size.begin(), size.end()) - size.begin();
+
+        std::vector<int> uncolored;
+        for (unsigned si = 0; si < segments.size(); si++)
+            if (colorv[si] == dropped)
+            {
+                uncolored.push_back(si);
+                move(si, -1);
+            }
+        k--;
+        if (dropped != k)
+        {
+            for (int &c : colorv)
+                if (c == k)
+                    c = dropped;
+            color_counts.move_color(k, dropped);
+        }
+        for (int si : uncolored)
+            move(si, least_conflicting_color(si));
+        tabu.assign(segments.size() * k, 0);
+    }
+
+    /**
+     * @brief search
+     * Run the tabu search with k colors until there is no conflict, or until the
+     * maximum running time
+     * @return True if the solution has no conflict
+     */
+    bool search()
+    {
+        long best_conflicts = nb_conflicts; // fewest conflicts seen with k colors, for the aspiration criterion
+        while (nb_conflicts > 0)
+        {
+            if (iteration % 1024 == 0 && elapsed_sec() > param.max_run_time)
+                return false;
+            iteration++;
+
+            // Find the best move of a conflicting segment. A tabu move is allowed if it
+            // leads to fewer conflicts than ever
+            int best_si = -1, best_c = -1, best_delta = std::numeric_limits<int>::max(), ties = 0;
+            for (int si : conflicted)
+            {
+                const int old_count = color_counts.count(si, colorv[si]);
+                const long *tabu_row = tabu.data() + (size_t) si * k;
+                for (int c = 0; c < k; c++)
+                {
+                    if (c == colorv[si])
+                        continue;
+                    const int delta = color_counts.count(si, c) - old_count;
+                    if (delta > best_delta || (tabu_row[c] > iteration && nb_conflicts + delta >= best_conflicts))
+                        continue;
+                    if (delta < best_delta)
+                    {
+                        best_delta = delta;
+                        ties = 0;
+                    }
+                    if (rng() % ++ties == 0)
+                    {
+                        best_si = si;
+                        best_c = c;
+                    }
+                }
+            }
+            if (best_si < 0) // every move is tabu
+            {
+                best_si = conflicted[rng() % conflicted.size()];
+                best_c = (colorv[best_si] + 1 + rng() % (k - 1)) % k;
+            }
+
+            tabu[(size_t) best_si * k + colorv[best_si]] = iteration + rng() % tenure_random + (long) (tenure_factor * conflicted.size());
+            move(best_si, best_c);
+            best_conflicts = std::min(best_conflicts, nb_conflicts);
+        }
+        return true;
+    }
+
+public:
+    TabuCol(Parameters param) : Solution(param), crossings(build_crossings())
+    {}
+
+    /**
+     * @brief color
+     * Remove colors one by one until the maximum running time, writing each
+     * solution without conflict. The solution is the best one at the end
+     */
+    virtual void color()
+    {
+        init_solution();
+        if (!search())
+            return;
+        std::vector<int> best = colorv;
+        while (k > 2 && elapsed_sec() < param.max_run_time) // the segments cross, so that one color is not enough
+        {
+            drop_color();
+            if (!search())
+                break;
+            best = colorv;
+            std::cout << "Colors: " << k << " after " << elapsed_sec() << " seconds and " << iteration << " iterations" << std::endl;
+            write_sol();
+        }
+        colorv = best;
+    }
+
+    virtual ~TabuCol() = default;
+};
+
+#endif // TABUCOL
@@ -0,0 +1,33 @@
+# Run the conflict optimizer for longer than the checkpoint interval, and check that
+# the checkpoint file is written at this interval (also during a long attempt to
+# remove a color), and that a run can resume from it.
+# Usage: cmake -DSOLVER=<executable> -DINSTANCE=<instance file> -DTHREADS=<n> -DWORKDIR=<directory> -P checkpoint.cmake
+
+set(RUN_TIME 8)
+set(INTERVAL 1)
+
+file(REMOVE_RECURSE ${WORKDIR})
+file(MAKE_DIRECTORY ${WORKDIR})
+file(WRITE ${WORKDIR}/params.json "{ \"instance\": \"${INSTANCE}\", \"algorithm\": \"conflict\", \"max_run_time\": ${RUN_TIME}, \"max_queue\": 1500000, \"threads\": ${THREADS}, \"checkpoint\": ${INTERVAL} }")
+
+execute_process(COMMAND ${SOLVER} -p params.json
+                WORKING_DIRECTORY ${WORKDIR}
+                RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE log)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "The solver failed:\n${output}\n${log}")
+endif()
+string(REGEX MATCHALL "Checkpoint saved" saved "${log}")
+list(LENGTH saved nb_saved)
+message(STATUS "${nb_saved} checkpoints written in ${RUN_TIME} seconds")
+if (nb_saved LESS 4)
+    message(FATAL_ERROR "Only ${nb_saved} checkpoints written in ${RUN_TIME} seconds, one every ${INTERVAL} seconds was expected")
+endif()
+
+file(GLOB checkpoint ${WORKDIR}/*.conflict.checkpoint)
+file(WRITE ${WORKDIR}/resume.json "{ \"instance\": \"${INSTANCE}\", \"algorithm\": \"conflict\", \"max_run_time\": 10, \"max_queue\": 1500000, \"threads\": ${THREADS} }")
+execute_process(COMMAND ${SOLVER} -p resume.json --resume ${checkpoint}
+                WORKING_DIRECTORY ${WORKDIR}
+                RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE log)
+if (NOT result EQUAL 0 OR NOT log MATCHES "Resuming ${THREADS} workers")
+    message(FATAL_ERROR "The solver failed to resume from ${checkpoint}:\n${output}\n${log}")
+endif()